@@ -0,0 +1,238 @@
+/*==============================================================================
+
+	main.cpp
+
+	joyframes: a tool to convert joyosc binary frames to text
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "../config.h" // automake config defines
+
+#include "Log.h"
+#include "Options.h"
+#include "../joyosc/joyosc_frame.h"
+
+#ifndef _WIN32
+
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static volatile sig_atomic_t s_run = 1;
+
+static void signalExit(int) {
+	s_run = 0;
+}
+
+// open & bind a udp socket on port, returns socket or -1 on error
+static int openPort(unsigned int port) {
+	struct addrinfo hints, *result = nullptr;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET6;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_PASSIVE;
+	std::string service = std::to_string(port);
+	int ret = getaddrinfo(nullptr, service.c_str(), &hints, &result);
+	if(ret != 0 || !result) {
+		LOG_ERROR << "could not resolve port " << port << ": "
+		          << gai_strerror(ret) << std::endl;
+		return -1;
+	}
+	int fd = socket(result->ai_family, SOCK_DGRAM, 0);
+	if(fd >= 0) {
+		int v6only = 0; // also receive ipv4
+		setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+		if(bind(fd, result->ai_addr, result->ai_addrlen) < 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+	if(fd < 0) {
+		LOG_ERROR << "could not open port " << port << ": "
+		          << strerror(errno) << std::endl;
+	}
+	freeaddrinfo(result);
+	return fd;
+}
+
+// open & bind a unix domain datagram socket, returns socket or -1 on error
+static int openSocket(const std::string &path) {
+	struct sockaddr_un address;
+	if(path.size() >= sizeof(address.sun_path)) {
+		LOG_ERROR << "socket path too long: " << path << std::endl;
+		return -1;
+	}
+	int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if(fd >= 0) {
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+		unlink(path.c_str()); // remove stale socket
+		if(bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+	if(fd < 0) {
+		LOG_ERROR << "could not open socket " << path << ": "
+		          << strerror(errno) << std::endl;
+	}
+	return fd;
+}
+
+// one line per record, values as ints or floats depending on the flags
+static void printRecord(const joyosc_frame_record &record, char separator) {
+	std::cout << record.time << separator << record.time_us << separator
+	          << record.device << separator << record.sequence << separator
+	          << joyosc_frame_type_name(record.type) << separator
+	          << record.id << separator
+	          << record.touchpad << separator << record.finger;
+	for(int i = 0; i < 3; ++i) {
+		std::cout << separator;
+		if(record.flags & JOYOSC_FRAME_FLOAT) {std::cout << record.values[i].f;}
+		else {std::cout << record.values[i].i;}
+	}
+	std::cout << "\n";
+}
+
+#endif
+
+int main(int argc, char **argv) {
+
+	unsigned int port = 8880;
+	std::string socketPath = "";
+	bool csv = false;
+
+	// option index enum
+	enum optionNames {
+		UNKNOWN,
+		HELP,
+		VERS,
+		SOCKET,
+		CSV,
+		VERBOSE
+	};
+
+	// option and usage print descriptors, note the use of the Options::Arg functions
+	// which provide extended type checks
+	const option::Descriptor usage[] = {
+		{UNKNOWN, 0, "", "", Options::Arg::Unknown, "Options:"},
+		{HELP, 0, "h", "help", Options::Arg::None, "  -h, --help \tprint usage and exit"},
+		{VERS, 0, "", "version", Options::Arg::None, "  --version \tprint version and exit"},
+		{SOCKET, 0, "s", "socket", Options::Arg::NonEmpty, "  -s, --socket \treceive on a unix domain socket path instead of a udp port"},
+		{CSV, 0, "c", "csv", Options::Arg::None, "  -c, --csv \tprint comma separated values with a header line"},
+		{VERBOSE, 0, "v", "verbose", Options::Arg::None, "  -v, --verbose \tverbose printing, ie. OSC packet addresses & lost datagrams"},
+		{0, 0, 0, 0, 0, 0}
+	};
+
+	// parse commandline
+	Options options("  receive joyosc binary frames & print them as text");
+	if(!options.parse(usage, argc, argv)) {
+		return EXIT_FAILURE;
+	}
+	if(options.isSet(HELP)) {
+		options.printUsage(usage, "[PORT]");
+		return EXIT_SUCCESS;
+	}
+	if(options.isSet(VERS)) {
+		LOG << VERSION << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	// read option values if set
+	if(options.numArguments() > 0) {
+		port = (unsigned int)std::stoul(options.getArgumentString(0));
+	}
+	if(options.isSet(SOCKET))  {socketPath = options.getString(SOCKET);}
+	if(options.isSet(CSV))     {csv = true;}
+	if(options.isSet(VERBOSE)) {Log::logLevel = Log::LEVEL_VERBOSE;}
+
+#ifdef _WIN32
+	LOG_ERROR << "not supported on this platform" << std::endl;
+	return EXIT_FAILURE;
+#else
+	int fd = (socketPath != "" ? openSocket(socketPath) : openPort(port));
+	if(fd < 0) {
+		return EXIT_FAILURE;
+	}
+	LOG_VERBOSE << "receiving on " << (socketPath != "" ? socketPath : std::to_string(port)) << std::endl;
+
+	// stop on ctrl+c, recv() is interrupted
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = signalExit;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	char separator = (csv ? ',' : ' ');
+	if(csv) {
+		std::cout << "time,time_us,device,sequence,type,id,touchpad,finger,value0,value1,value2\n";
+	}
+
+	// frame datagrams & OSC packets share the destination, OSC packets are
+	// skipped, ie. notifications
+	char buffer[65536];
+	uint32_t next = 0;
+	bool started = false;
+	uint64_t lost = 0;
+	while(s_run) {
+		ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+		if(size < 0) {
+			if(errno == EINTR) {continue;}
+			LOG_ERROR << "receive failed: " << strerror(errno) << std::endl;
+			break;
+		}
+		uint32_t sequence = 0;
+		int count = joyosc_frame_count(buffer, (size_t)size, &sequence);
+		if(count < 0) {
+			if(size > 0 && buffer[0] == '/') {
+				LOG_VERBOSE << "osc " << std::string(buffer, strnlen(buffer, size)) << std::endl;
+			}
+			else {
+				LOG_VERBOSE << "skipped " << size << " byte packet" << std::endl;
+			}
+			continue;
+		}
+		if(started && sequence != next) {
+			// unsigned difference handles wraparound
+			lost += (uint32_t)(sequence - next);
+			LOG_VERBOSE << "lost " << (uint32_t)(sequence - next) << " datagrams" << std::endl;
+		}
+		next = sequence + 1;
+		started = true;
+		for(int i = 0; i < count; ++i) {
+			joyosc_frame_record record;
+			joyosc_frame_read(buffer, i, &record);
+			printRecord(record, separator);
+		}
+		std::cout.flush();
+	}
+
+	if(socketPath != "") {
+		unlink(socketPath.c_str());
+	}
+	::close(fd);
+	if(lost > 0) {
+		LOG_WARN << "lost " << lost << " datagrams" << std::endl;
+	}
+	return EXIT_SUCCESS;
+#endif
+}
@@ -25,20 +25,28 @@
 #include "Path.h"
 #include "Options.h"
 #include "GameController.h"
+#include "../shared.h"
 
 #if defined( __WIN32__ ) || defined( _WIN32 )
 	#include <windows.h>
 #endif
 #include <unistd.h>
 #include <signal.h> // signal handling
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#ifndef _WIN32
+	#include <pthread.h>
+	#include <sched.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
 
 using namespace tinyxml2;
 
-static App *appPtr; // global app this pointer
+volatile std::sig_atomic_t App::s_signalCaught = 0;
 
-App::App() {
-	appPtr = this;
-}
+App::App() {}
 
 bool App::parseCommandLine(int argc, char **argv) {
 
@@ -49,17 +57,36 @@ bool App::parseCommandLine(int argc, char **argv) {
 		VERS,
 		IP,
 		PORT,
+		TCP,
+		SOCKET,
 		LISTENPORT,
 		MULTICAST,
+		LISTENSOCKET,
 		EVENTS,
 		JSONLY,
 		WINDOW,
 		WINSIZE,
 		SLEEP,
+		LOOP,
+		SENDTHREAD,
+		BUNDLE,
+		TIMETAGS,
+		REALTIME,
+		PRIORITY,
+		CPU,
+		SPIN,
+		COALESCE,
+		STATERATE,
+		STATEONLY,
+		STATETABLE,
+		SYNC,
+		KEYFRAME,
 		TRIGGER,
 		SENSORS,
 		RATE,
 		NORM,
+		NUMERIC,
+		INPUTADDR,
 		START,
 		VERBOSE
 	};
@@ -80,12 +107,21 @@ bool App::parseCommandLine(int argc, char **argv) {
 		{MULTICAST, 0, "m", "multicast", Options::Arg::NonEmpty,
 			"  -m, --multicast \tmulticast listening group address (off by default)"
 		},
+		{LISTENSOCKET, 0, "", "listening-socket", Options::Arg::NonEmpty,
+			"  --listening-socket \tlisten on a unix domain socket path instead of a port (off by default)"
+		},
 		{IP, 0, "i", "ip", Options::Arg::NonEmpty,
 			"  -i, --ip \tip address, hostname, or multicast group to send to (default: 127.0.0.1)"
 		},
 		{PORT, 0, "p", "port", Options::Arg::Integer,
 			"  -p, --port \tport to send to (default: 8880)"
 		},
+		{TCP, 0, "", "tcp", Options::Arg::None,
+			"  --tcp \tsend over TCP with SLIP framing instead of UDP for reliable delivery"
+		},
+		{SOCKET, 0, "", "socket", Options::Arg::NonEmpty,
+			"  --socket \tunix domain socket path to send to instead of ip & port (off by default)"
+		},
 		{EVENTS, 0, "e", "events", Options::Arg::None,
 			"  -e, --events \tprint incoming events, useful for debugging"
 		},
@@ -101,6 +137,48 @@ bool App::parseCommandLine(int argc, char **argv) {
 		{SLEEP, 0, "", "sleep", Options::Arg::Integer,
 			"  --sleep \tsleep time in usecs (default: 10000)"
 		},
+		{LOOP, 0, "", "loop", Options::Arg::NonEmpty,
+			"  --loop \trun loop mode: poll, wait (checks every ms), or adaptive (default: poll)"
+		},
+		{SENDTHREAD, 0, "", "send-thread", Options::Arg::None,
+			"  --send-thread \tsend events from a dedicated thread so event handling never blocks on the network"
+		},
+		{BUNDLE, 0, "b", "bundle", Options::Arg::None,
+			"  -b, --bundle \tsend all event messages from each loop iteration in a single bundle"
+		},
+		{TIMETAGS, 0, "", "timetags", Options::Arg::None,
+			"  --timetags \tsend events in bundles timetagged with the time the input happened"
+		},
+		{REALTIME, 0, "", "realtime", Options::Arg::None,
+			"  --realtime \tlock memory & run the event thread with real-time priority, may require privileges"
+		},
+		{PRIORITY, 0, "", "priority", Options::Arg::Integer,
+			"  --priority \treal-time priority 1-99 (default: 50)"
+		},
+		{CPU, 0, "", "cpu", Options::Arg::Integer,
+			"  --cpu \tpin the event thread to a cpu core in real-time mode, Linux only (default: none)"
+		},
+		{SPIN, 0, "", "spin", Options::Arg::Integer,
+			"  --spin \tbusy poll time in usecs after each event before sleeping (default: 0)"
+		},
+		{COALESCE, 0, "c", "coalesce", Options::Arg::None,
+			"  -c, --coalesce \tonly send the latest axis & touchpad motion values per loop iteration, buttons are always sent"
+		},
+		{STATERATE, 0, "", "state-rate", Options::Arg::Integer,
+			"  --state-rate \tsend whole device state snapshots at a fixed rate in hz (default: 0)"
+		},
+		{STATEONLY, 0, "", "state-only", Options::Arg::None,
+			"  --state-only \tonly send state snapshots, no individual device events"
+		},
+		{STATETABLE, 0, "", "state-table", Options::Arg::NonEmpty,
+			"  --state-table \tpublish device state in a shared memory object by name, ie. joyosc (off by default)"
+		},
+		{SYNC, 0, "", "sync", Options::Arg::None,
+			"  --sync \tadd per-device sequence numbers to event messages & send keyframes to recover from lost messages"
+		},
+		{KEYFRAME, 0, "", "keyframe-interval", Options::Arg::Integer,
+			"  --keyframe-interval \tkeyframe interval in ms when syncing, 0 to only send on request (default: 1000)"
+		},
 		{TRIGGER, 0, "t", "triggers", Options::Arg::None,
 			"  -t, --triggers \treport trigger buttons as axis values"
 		},
@@ -113,6 +191,12 @@ bool App::parseCommandLine(int argc, char **argv) {
 		{NORM, 0, "n", "normalize", Options::Arg::None,
 			"  -n, --normalize \tnormalize axis values"
 		},
+		{NUMERIC, 0, "", "numeric-ids", Options::Arg::None,
+			"  --numeric-ids \tsend game controller button, axis, & sensor ids instead of names, see /joyosc/query/schema"
+		},
+		{INPUTADDR, 0, "a", "input-addresses", Options::Arg::None,
+			"  -a, --input-addresses \tsend each input on its own address, ie. /joyosc/devices/gc0/button/a 1"
+		},
 		{START, 0, "", "start", Options::Arg::Integer,
 			"  --start \tdefault address start index, ie. /gc# (default: 0)"
 		},
@@ -151,10 +235,13 @@ bool App::parseCommandLine(int argc, char **argv) {
 	}
 
 	// read option values if set
-	if(options.isSet(IP))         {sendingIp = options.getString(IP);}
-	if(options.isSet(PORT))       {sendingPort = options.getUInt(PORT);}
+	if(options.isSet(IP))         {destinations[0].ip = options.getString(IP);}
+	if(options.isSet(PORT))       {destinations[0].port = options.getUInt(PORT);}
+	if(options.isSet(TCP))        {destinations[0].tcp = true;}
+	if(options.isSet(SOCKET))     {destinations[0].socket = options.getString(SOCKET);}
 	if(options.isSet(LISTENPORT)) {listeningPort = options.getUInt(LISTENPORT);}
 	if(options.isSet(MULTICAST))  {listeningMulticast = options.getString(MULTICAST);}
+	if(options.isSet(LISTENSOCKET)) {listeningSocket = options.getString(LISTENSOCKET);}
 	if(options.isSet(EVENTS))     {Device::printEvents = true;}
 	if(options.isSet(JSONLY))     {m_deviceManager.joysticksOnly = true;}
 	if(options.isSet(WINDOW))     {openWindow = true;}
@@ -183,12 +270,32 @@ bool App::parseCommandLine(int argc, char **argv) {
 		}
 	}
 	if(options.isSet(SLEEP))   {sleepUS = options.getUInt(SLEEP);}
+	if(options.isSet(LOOP)) {
+		if(!loopModeForName(options.getString(LOOP), loopMode)) {
+			LOG_WARN << "ignoring invalid loop mode: " << options.getString(LOOP) << std::endl;
+		}
+	}
+	if(options.isSet(SENDTHREAD)) {sendThread = true;}
+	if(options.isSet(BUNDLE))     {bundle = true;}
+	if(options.isSet(TIMETAGS))   {timetags = true;}
+	if(options.isSet(REALTIME))   {realtime = true;}
+	if(options.isSet(PRIORITY))   {realtimePriority = options.getInt(PRIORITY);}
+	if(options.isSet(CPU))        {realtimeCPU = options.getInt(CPU);}
+	if(options.isSet(SPIN))       {spinUS = options.getUInt(SPIN);}
+	if(options.isSet(COALESCE))   {coalesceEvents = true;}
+	if(options.isSet(STATERATE))  {stateRate = options.getUInt(STATERATE);}
+	if(options.isSet(STATEONLY))  {Device::streamEvents = false;}
+	if(options.isSet(STATETABLE)) {stateTable = options.getString(STATETABLE);}
+	if(options.isSet(SYNC))       {Device::sync = true;}
+	if(options.isSet(KEYFRAME))   {keyframeInterval = options.getUInt(KEYFRAME);}
 	if(options.isSet(TRIGGER)) {GameController::triggersAsAxes = true;}
 	if(options.isSet(SENSORS)) {GameController::enableSensors = true;}
 	if(options.isSet(RATE) && options.getInt(RATE) > 0) {
 		GameController::sensorRateMS = 1000 / options.getUInt(RATE); // hz -> ms
 	}
 	if(options.isSet(NORM)) {Device::normalizeAxes = true;}
+	if(options.isSet(NUMERIC)) {GameController::numericIds = true;}
+	if(options.isSet(INPUTADDR)) {Device::inputAddresses = true;}
 	if(options.isSet(START) && options.getInt(START) > 0) {
 		m_deviceManager.startIndex = options.getUInt(START);
 	}
@@ -201,9 +308,22 @@ void App::run() {
 		print();
 	}
 
+	// custom event to wake the main loop from other threads
+	m_wakeEvent = SDL_RegisterEvents(1);
+
 	// setup OSC interface
 	try {
-		if(listeningMulticast == "") {
+		if(listeningSocket != "") {
+#ifndef _WIN32
+			// remove a stale socket left by an unclean exit, bind fails otherwise
+			struct stat info;
+			if(stat(listeningSocket.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+				unlink(listeningSocket.c_str());
+			}
+#endif
+			m_receiver = new lo::ServerThread(listeningSocket, LO_UNIX, &App::oscError);
+		}
+		else if(listeningMulticast == "") {
 			m_receiver = new lo::ServerThread(listeningPort, 0, &App::oscError);
 		}
 		else {
@@ -214,8 +334,70 @@ void App::run() {
 			LOG_VERBOSE << std::endl << "	" << PACKAGE << ": quit message received, exiting ..." << std::endl;
 			return 0; // handled
 		});
+		m_receiver->add_method("/" PACKAGE "/query/queue", "", [this]() {
+			m_sender->sendReply(DeviceManager::queryAddress + "/queue", "iiiii",
+				(int)m_sender->queueDepth(), (int)m_sender->queueOverflows(),
+				(int)m_sender->queueDropped(), (int)m_sender->queueOverwritten(),
+				(int)m_sender->queueGrown());
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/query/time", "", [this]() {
+			// current NTP time as a 32.32 fixed point int64 to estimate the
+			// event timetag clock offset
+			lo_timetag now;
+			lo_timetag_now(&now);
+			m_sender->sendReply(DeviceManager::queryAddress + "/time", "h",
+				(int64_t)(((uint64_t)now.sec << 32) | now.frac));
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/flow", "i", [this](lo_arg** argv, int argc) {
+			m_sender->setFlow("", (unsigned int)MAX(argv[0]->i, 0));
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/flow", "si", [this](lo_arg** argv, int argc) {
+			std::string name(&argv[0]->s);
+			if(!m_sender->setFlow(name, (unsigned int)MAX(argv[1]->i, 0))) {
+				LOG_WARN << "flow: unknown destination " << name << std::endl;
+			}
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/resync", "", [this]() {
+			m_deviceManager.requestKeyframe("");
+			wake();
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/resync", "s", [this](lo_arg** argv, int argc) {
+			m_deviceManager.requestKeyframe("/" + std::string(&argv[0]->s));
+			wake();
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/resync", "si", [this](lo_arg** argv, int argc) {
+			// no history is kept, so a missed sequence number is answered
+			// with a keyframe
+			LOG_DEBUG << "resync: /" << &argv[0]->s << " missed " << argv[1]->i << std::endl;
+			m_deviceManager.requestKeyframe("/" + std::string(&argv[0]->s));
+			wake();
+			return 0; // handled
+		});
+		m_receiver->add_method("/" PACKAGE "/query/stats", "", [this]() {
+			m_sender->sendReply(DeviceManager::queryAddress + "/stats", "hhh",
+				(int64_t)m_sender->messagesSent(), (int64_t)m_sender->packetsSent(),
+				(int64_t)m_sender->sendCalls());
+			return 0; // handled
+		});
 		m_deviceManager.subscribe(m_receiver);
-		m_sender = new lo::Address(sendingIp, sendingPort);
+		m_sender = new Sender;
+		m_sender->threaded = sendThread;
+		m_sender->queueSize = sendQueueSize;
+		m_sender->bundle = bundle;
+		m_sender->bundleMTU = bundleMTU;
+		m_sender->bundleNotifications = bundleNotifications;
+		m_sender->bundleReplies = bundleReplies;
+		m_sender->timetags = timetags;
+		m_sender->bundleCallback = [this]() {wake();};
+		for(auto &destination : destinations) {
+			m_sender->addDestination(destination);
+		}
 		Device::sender = m_sender;
 	}
 	catch(lo::Invalid &e) {
@@ -225,7 +407,7 @@ void App::run() {
 		exit(EXIT_FAILURE);
 	}
 
-	m_sender->send(DeviceManager::notificationAddress + "/startup");
+	m_sender->sendNotification(DeviceManager::notificationAddress + "/startup");
 
 	// set signal handling
 	signal(SIGTERM, signalExit); // terminate
@@ -234,47 +416,106 @@ void App::run() {
 	signal(SIGQUIT, signalExit); // quit
 #endif
 
+	// publish state before opening devices so they take a slot
+	if(stateTable != "" && m_stateTable.open(stateTable)) {
+		Device::stateTable = &m_stateTable;
+	}
+
 	// open all currently plugged in devices before mainloop
 	m_deviceManager.openAll();
 	m_deviceManager.sendDeviceEvents = true;
 
-	m_sender->send(DeviceManager::notificationAddress + "/ready");
+	m_sender->sendNotification(DeviceManager::notificationAddress + "/ready");
 	
+	m_sender->start();
 	m_receiver->start();
+	if(realtime) {
+		// after starting the other threads so they don't inherit the policy
+		setupRealtime();
+	}
+	m_adaptiveSleepUS = sleepFloorUS;
+	m_nextStateTime = SDL_GetPerformanceCounter();
+	m_nextKeyframeTime = m_nextStateTime;
+	if(stateRate == 0 && !Device::streamEvents) {
+		LOG_WARN << "event stream disabled without a state rate, "
+		         << "no device events will be sent" << std::endl;
+	}
 	m_run = true;
 	while(m_run) {
-
-		// handle any joystick events
-		SDL_Event event;
-		while(SDL_PollEvent(&event)) {
-			if(!m_deviceManager.handleEvent(&event)) {
-				switch(event.type) {
-					case SDL_WINDOWEVENT: // only if window opened
-						if(event.window.event == SDL_WINDOWEVENT_EXPOSED) {
-							SDL_Window *window = SDL_GetWindowFromID(event.window.windowID);
-							if(window) {
-								updateWindow(window);
-							}
-						}
-						break;
-					case SDL_QUIT:
-						m_run = false;
-						break;
-				}
+		if(s_signalCaught) {
+			m_run = false;
+			LOG_VERBOSE << std::endl << "	" << PACKAGE << ": signal caught, exiting ..." << std::endl;
+			break;
+		}
+		bool active = false;
+		if(loopMode == LOOP_WAIT) {
+			// wait until an event or wakeup arrives without removing it,
+			// then drain the queue, the timeout is only a fallback in case a
+			// wakeup gets lost or a state snapshot is due
+			// note: without the video subsystem, SDL2 waits by pumping events
+			// every 1 ms as joystick input is only read while pumping
+			// the timeout also bounds how long a caught signal waits as a
+			// signal handler cannot wake SDL safely
+			unsigned int timeoutUS = MIN(usUntilDue(), 100000u);
+			if(SDL_WaitEventTimeout(nullptr, (timeoutUS + 999) / 1000)) {
+				active = pollEvents();
 			}
 		}
-
-		// and 2 cents for the scheduler ...
-		usleep(sleepUS);
+		else {
+			active = pollEvents();
+		}
+		if(active && spinUS > 0) {
+			spinEvents();
+		}
+		if(m_deviceManager.isOpening()) {
+			// send events first as opening a device may take a while
+			m_sender->flush();
+			m_deviceManager.openPending();
+		}
+		if(stateRate > 0) {
+			sendStates();
+		}
+		sendKeyframes();
+		m_sender->flush();
+		if(m_run) {
+			idle(active);
+		}
 	}
 	m_receiver->stop();
+	m_receiver->del_method("/" PACKAGE "/query/queue", "");
+	m_receiver->del_method("/" PACKAGE "/query/stats", "");
+	m_receiver->del_method("/" PACKAGE "/query/time", "");
+	m_receiver->del_method("/" PACKAGE "/flow", "i");
+	m_receiver->del_method("/" PACKAGE "/flow", "si");
+	m_receiver->del_method("/" PACKAGE "/resync", "");
+	m_receiver->del_method("/" PACKAGE "/resync", "s");
+	m_receiver->del_method("/" PACKAGE "/resync", "si");
 	m_deviceManager.unsubscribe(m_receiver);
+#ifndef _WIN32
+	if(listeningSocket != "") {
+		unlink(listeningSocket.c_str());
+	}
+#endif
 
 	// close all opened devices
 	m_deviceManager.sendDeviceEvents = false;
 	m_deviceManager.closeAll();
+	Device::stateTable = nullptr;
+	m_stateTable.close();
 
-	m_sender->send(DeviceManager::notificationAddress + "/shutdown");
+	m_sender->stop();
+	m_sender->sendNotification(DeviceManager::notificationAddress + "/shutdown");
+	if(coalesceEvents && Log::logLevel < Log::LEVEL_NORMAL) {
+		m_coalescer.print();
+	}
+}
+
+void App::wake() {
+	if(m_wakeEvent == (Uint32)-1) {return;}
+	SDL_Event event;
+	SDL_zero(event);
+	event.type = m_wakeEvent;
+	SDL_PushEvent(&event);
 }
 
 // try loading icon
@@ -298,17 +539,57 @@ void App::updateWindow(SDL_Window *window) {
 void App::print() {
 	LOG << "listening port:	 " << listeningPort << std::endl
 	    << "listening multicast group: " << (listeningMulticast == "" ? "none" : listeningMulticast) << std::endl
+	    << "listening socket: " << (listeningSocket == "" ? "none" : listeningSocket) << std::endl
 	    << "listening address: " << "/" << PACKAGE << std::endl
-	    << "sending ip:      " << sendingIp << std::endl
-	    << "sending port:    " << sendingPort << std::endl
-	    << "notification address: " << DeviceManager::notificationAddress << std::endl
+	    << "sending ip:      " << destinations[0].ip << std::endl
+	    << "sending port:    " << destinations[0].port << std::endl
+	    << "sending tcp?:    " << (destinations[0].tcp ? "true" : "false") << std::endl
+	    << "sending socket:  " << (destinations[0].socket == "" ? "none" : destinations[0].socket) << std::endl;
+	for(size_t i = 0; i < destinations.size(); ++i) {
+		if(i == 0 && !destinations[0].isFiltered() && !destinations[0].frames) {
+			continue; // printed above
+		}
+		LOG << "sending " << (i == 0 ? "main" : destinations[i].name) << ": "
+		    << destinations[i].toString() << std::endl;
+	}
+	LOG << "notification address: " << DeviceManager::notificationAddress << std::endl
 	    << "device address:       " << Device::deviceAddress << std::endl
 	    << "query address:        " << DeviceManager::queryAddress << std::endl
 	    << "print events?:   " << (Device::printEvents ? "true" : "false") << std::endl
 	    << "joysticks only?: " << (m_deviceManager.joysticksOnly ? "true" : "false") << std::endl
 	    << "sleep us:        " << sleepUS << std::endl
-	    << "triggers as axes?: " << (GameController::triggersAsAxes ? "true" : "false") << std::endl
+	    << "loop mode:       " << loopModeName(loopMode) << std::endl;
+	if(loopMode == LOOP_ADAPTIVE) {
+		LOG << "sleep floor us:   " << sleepFloorUS << std::endl
+		    << "sleep ceiling us: " << sleepCeilingUS << std::endl
+		    << "deep sleep us:    " << deepSleepUS << std::endl;
+	}
+	LOG << "send thread?:    " << (sendThread ? "true" : "false") << std::endl
+	    << "bundle?:         " << (bundle ? "true" : "false") << std::endl;
+	if(bundle) {
+		LOG << "bundle mtu:           " << bundleMTU << std::endl
+		    << "bundle notifications?: " << (bundleNotifications ? "true" : "false") << std::endl
+		    << "bundle replies?:       " << (bundleReplies ? "true" : "false") << std::endl;
+	}
+	LOG << "timetags?:       " << (timetags ? "true" : "false") << std::endl
+	    << "realtime?:       " << (realtime ? "true" : "false") << std::endl;
+	if(realtime) {
+		LOG << "realtime priority: " << realtimePriority << std::endl
+		    << "realtime cpu:      " << (realtimeCPU < 0 ? "none" : std::to_string(realtimeCPU)) << std::endl;
+	}
+	LOG << "spin us:         " << spinUS << std::endl
+	    << "coalesce events?: " << (coalesceEvents ? "true" : "false") << std::endl
+	    << "state rate:      " << (stateRate > 0 ? std::to_string(stateRate) + "hz" : "off") << std::endl
+	    << "stream events?:  " << (Device::streamEvents ? "true" : "false") << std::endl
+	    << "state table:     " << (stateTable == "" ? "none" : stateTable) << std::endl
+	    << "sync?:           " << (Device::sync ? "true" : "false") << std::endl;
+	if(Device::sync) {
+		LOG << "keyframe interval: " << (keyframeInterval > 0 ? std::to_string(keyframeInterval) + "ms" : "on request") << std::endl;
+	}
+	LOG << "triggers as axes?: " << (GameController::triggersAsAxes ? "true" : "false") << std::endl
 	    << "normalize axes?: " << (Device::normalizeAxes ? "true" : "false") << std::endl
+	    << "numeric ids?:    " << (GameController::numericIds ? "true" : "false") << std::endl
+	    << "input addresses?: " << (Device::inputAddresses ? "true" : "false") << std::endl
 	    << "enable sensors?: " << (GameController::enableSensors ? "true" : "false") << std::endl;
 	if(GameController::sensorRateMS > 0) {
 		LOG << "sensor rate:     " << 1000 / GameController::sensorRateMS << "hz" << std::endl; // ms -> hz
@@ -321,8 +602,228 @@ void App::print() {
 	m_deviceManager.printExclusions();
 }
 
+// STATIC UTILS
+
+std::string App::loopModeName(LoopMode mode) {
+	switch(mode) {
+		case LOOP_WAIT:     return "wait";
+		case LOOP_ADAPTIVE: return "adaptive";
+		default:            return "poll";
+	}
+}
+
+bool App::loopModeForName(const std::string &name, LoopMode &mode) {
+	if(name == "poll") {
+		mode = LOOP_POLL;
+		return true;
+	}
+	else if(name == "wait") {
+		mode = LOOP_WAIT;
+		return true;
+	}
+	else if(name == "adaptive") {
+		mode = LOOP_ADAPTIVE;
+		return true;
+	}
+	return false;
+}
+
 // PROTECTED
 
+void App::handleEvent(SDL_Event *event) {
+	if(m_deviceManager.handleEvent(event)) {
+		return;
+	}
+	switch(event->type) {
+		case SDL_WINDOWEVENT: // only if window opened
+			if(event->window.event == SDL_WINDOWEVENT_EXPOSED) {
+				SDL_Window *window = SDL_GetWindowFromID(event->window.windowID);
+				if(window) {
+					updateWindow(window);
+				}
+			}
+			break;
+		case SDL_QUIT:
+			m_run = false;
+			break;
+		default: // m_wakeEvent, nothing to do
+			break;
+	}
+}
+
+bool App::pollEvents() {
+	bool handled = false;
+	if(coalesceEvents) {
+		size_t count = 0;
+		while(m_run && (count = m_coalescer.drain()) > 0) {
+			for(size_t i = 0; i < count && m_run; ++i) {
+				if(m_coalescer.isKept(i)) {
+					handleEvent(&m_coalescer.event(i));
+				}
+			}
+			handled = true;
+		}
+		return handled;
+	}
+	SDL_Event event;
+	while(m_run && SDL_PollEvent(&event)) {
+		handleEvent(&event);
+		handled = true;
+	}
+	return handled;
+}
+
+void App::spinEvents() {
+	// SDL_PollEvent pumps joystick updates itself, so keep polling while
+	// events keep arriving within the window to avoid scheduler wakeup latency
+	const Uint64 window = (Uint64)spinUS * SDL_GetPerformanceFrequency() / 1000000;
+	Uint64 last = SDL_GetPerformanceCounter();
+	while(m_run && SDL_GetPerformanceCounter() - last < window) {
+		if(pollEvents()) {
+			m_sender->flush();
+			last = SDL_GetPerformanceCounter();
+		}
+	}
+}
+
+void App::idle(bool active) {
+	switch(loopMode) {
+		case LOOP_WAIT: // waits in SDL_WaitEventTimeout
+			break;
+		case LOOP_ADAPTIVE:
+			// sleep at the floor while events are flowing, back off
+			// exponentially to the ceiling while quiet, & sleep deeply
+			// if there are no devices to wait for
+			// note: hotplug events are only seen when SDL pumps events, so
+			// a new device may wait up to deepSleepUS before it is opened
+			if(active) {
+				m_adaptiveSleepUS = sleepFloorUS;
+			}
+			else {
+				// double from at least 1 us so a 0 floor still backs off
+				m_adaptiveSleepUS = MIN(MAX(m_adaptiveSleepUS * 2, MAX(sleepFloorUS, 1u)),
+				                        sleepCeilingUS);
+			}
+			usleep(m_deviceManager.size() == 0 && !m_deviceManager.isOpening() ? deepSleepUS :
+			       MIN(m_adaptiveSleepUS, usUntilDue()));
+			break;
+		default: // LOOP_POLL
+			// and 2 cents for the scheduler ...
+			usleep(MIN(sleepUS, usUntilDue()));
+			break;
+	}
+}
+
+void App::sendStates() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(now < m_nextStateTime) {return;}
+	m_deviceManager.sendStates();
+	// keep a steady rate, but skip missed snapshots instead of bursting
+	Uint64 period = SDL_GetPerformanceFrequency() / stateRate;
+	m_nextStateTime += period;
+	if(m_nextStateTime <= now) {
+		m_nextStateTime = now + period;
+	}
+}
+
+// keyframes are only a fallback for lost messages, so a late loop simply
+// sends the next one late instead of catching up
+void App::sendKeyframes() {
+	m_deviceManager.sendRequestedKeyframes();
+	if(!Device::sync || keyframeInterval == 0) {return;}
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(now < m_nextKeyframeTime) {return;}
+	m_deviceManager.sendKeyframes();
+	m_nextKeyframeTime = now + SDL_GetPerformanceFrequency() * keyframeInterval / 1000;
+}
+
+unsigned int App::usUntilDue() {
+	if(m_deviceManager.isOpening()) {return 0;} // next open step
+	return MIN(MIN(usUntilStates(), usUntilKeyframes()), m_sender->usUntilHeld());
+}
+
+unsigned int App::usUntilStates() {
+	if(stateRate == 0) {return UINT_MAX;}
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(now >= m_nextStateTime) {return 0;}
+	return (unsigned int)((m_nextStateTime - now) * 1000000 / SDL_GetPerformanceFrequency());
+}
+
+unsigned int App::usUntilKeyframes() {
+	if(!Device::sync || keyframeInterval == 0) {return UINT_MAX;}
+	Uint64 now = SDL_GetPerformanceCounter();
+	if(now >= m_nextKeyframeTime) {return 0;}
+	return (unsigned int)((m_nextKeyframeTime - now) * 1000000 / SDL_GetPerformanceFrequency());
+}
+
+bool App::setupRealtime() {
+	int failed = 0;
+#ifdef _WIN32
+	LOG_WARN << "realtime: memory locking not supported on this platform" << std::endl;
+	LOG_WARN << "realtime: real-time priority not supported on this platform" << std::endl;
+	failed += 2;
+	if(realtimeCPU >= 0) {
+		LOG_WARN << "realtime: cpu pinning not supported on this platform" << std::endl;
+		failed++;
+	}
+#else
+	// keep current & future pages resident so page faults can't stall events
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+		LOG_VERBOSE << "realtime: locked memory" << std::endl;
+	}
+	else {
+		LOG_WARN << "realtime: could not lock memory: " << strerror(errno)
+		         << " (check RLIMIT_MEMLOCK or CAP_IPC_LOCK)" << std::endl;
+		failed++;
+	}
+
+	// pthread functions return the error instead of setting errno
+	int min = sched_get_priority_min(SCHED_FIFO);
+	int max = sched_get_priority_max(SCHED_FIFO);
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = CLAMP(realtimePriority, min, max);
+	if(param.sched_priority != realtimePriority) {
+		LOG_WARN << "realtime: priority " << realtimePriority << " out of range "
+		         << min << "-" << max << ", using " << param.sched_priority << std::endl;
+	}
+	int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if(ret == 0) {
+		LOG_VERBOSE << "realtime: set SCHED_FIFO priority " << param.sched_priority << std::endl;
+	}
+	else {
+		LOG_WARN << "realtime: could not set SCHED_FIFO priority " << param.sched_priority
+		         << ": " << strerror(ret) << " (check RLIMIT_RTPRIO or CAP_SYS_NICE)" << std::endl;
+		failed++;
+	}
+
+	if(realtimeCPU >= 0) {
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(realtimeCPU, &set);
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if(ret == 0) {
+			LOG_VERBOSE << "realtime: pinned event thread to cpu " << realtimeCPU << std::endl;
+		}
+		else {
+			LOG_WARN << "realtime: could not pin event thread to cpu "
+			         << realtimeCPU << ": " << strerror(ret) << std::endl;
+			failed++;
+		}
+#else
+		LOG_WARN << "realtime: cpu pinning not supported on this platform" << std::endl;
+		failed++;
+#endif
+	}
+#endif
+	if(failed > 0) {
+		LOG_WARN << "realtime: " << failed << " part(s) failed, "
+		         << "running with reduced real-time guarantees" << std::endl;
+	}
+	return failed == 0;
+}
+
 // use tinyxml2::XMLDocument as an XMLDocument clas also exists in msys ucrt64
 bool App::loadXMLFile(const std::string &path) {
 	XMLElement *root = nullptr, *child = nullptr;
@@ -357,12 +858,24 @@ bool App::loadXMLFile(const std::string &path) {
 				listeningMulticast = std::string(child->Attribute("multicast"));
 			}
 			child->QueryUnsignedAttribute("port", &listeningPort);
+			if(child->Attribute("socket")) {
+				listeningSocket = std::string(child->Attribute("socket"));
+			}
 		}
 		else if((std::string)child->Name() == "sending") {
-			if(child->Attribute("ip")) {
-				sendingIp = std::string(child->Attribute("ip"));
+			// without a name sets the main destination, otherwise adds or
+			// updates a named destination
+			std::string name = (child->Attribute("name") ? child->Attribute("name") : "");
+			size_t i = 0;
+			for(; i < destinations.size(); ++i) {
+				if(destinations[i].name == name) {break;}
+			}
+			DestinationSettings settings;
+			if(i < destinations.size()) {settings = destinations[i];}
+			if(settings.readXML(child)) {
+				if(i < destinations.size()) {destinations[i] = settings;}
+				else {destinations.push_back(settings);}
 			}
-			child->QueryUnsignedAttribute("port", &sendingPort);
 		}
 		else if((std::string)child->Name() == "address") {
 			if(child->Attribute("notification")) {
@@ -380,7 +893,7 @@ bool App::loadXMLFile(const std::string &path) {
 					LOG_WARN << "invalid device address: " << address << std::endl;
 				}
 				else {
-					Device::deviceAddress = address;
+					m_deviceManager.setDeviceAddress(address);
 				}
 			}
 			if(child->Attribute("query")) {
@@ -398,8 +911,55 @@ bool App::loadXMLFile(const std::string &path) {
 			child->QueryBoolAttribute("joysticksOnly", &m_deviceManager.joysticksOnly);
 			child->QueryBoolAttribute("openWindow", &openWindow);
 			child->QueryUnsignedAttribute("sleepUS", &sleepUS);
+			if(child->Attribute("loopMode")) {
+				std::string mode(child->Attribute("loopMode"));
+				if(!loopModeForName(mode, loopMode)) {
+					LOG_WARN << "invalid loop mode: " << mode << std::endl;
+				}
+			}
+			child->QueryUnsignedAttribute("sleepFloorUS", &sleepFloorUS);
+			if(child->QueryUnsignedAttribute("sleepCeilingUS", &sleepCeilingUS) == XML_SUCCESS &&
+				sleepCeilingUS == 0) {
+				LOG_WARN << "invalid sleep ceiling: 0" << std::endl;
+				sleepCeilingUS = 50000;
+			}
+			child->QueryUnsignedAttribute("deepSleepUS", &deepSleepUS);
+			if(sleepCeilingUS < sleepFloorUS) {
+				LOG_WARN << "sleep ceiling less than floor, using floor: "
+				         << sleepFloorUS << std::endl;
+				sleepCeilingUS = sleepFloorUS;
+			}
+			child->QueryBoolAttribute("sendThread", &sendThread);
+			if(child->QueryUnsignedAttribute("sendQueueSize", &sendQueueSize) == XML_SUCCESS &&
+				sendQueueSize == 0) {
+				LOG_WARN << "invalid send queue size: 0" << std::endl;
+				sendQueueSize = 1024;
+			}
+			child->QueryBoolAttribute("bundle", &bundle);
+			if(child->QueryUnsignedAttribute("bundleMTU", &bundleMTU) == XML_SUCCESS &&
+				bundleMTU < 64) {
+				LOG_WARN << "bundle mtu too small, using 64: " << bundleMTU << std::endl;
+				bundleMTU = 64;
+			}
+			child->QueryBoolAttribute("bundleNotifications", &bundleNotifications);
+			child->QueryBoolAttribute("bundleReplies", &bundleReplies);
+			child->QueryBoolAttribute("timetags", &timetags);
+			child->QueryBoolAttribute("realtime", &realtime);
+			child->QueryIntAttribute("realtimePriority", &realtimePriority);
+			child->QueryIntAttribute("realtimeCPU", &realtimeCPU);
+			child->QueryUnsignedAttribute("spinUS", &spinUS);
+			child->QueryBoolAttribute("coalesceEvents", &coalesceEvents);
+			child->QueryUnsignedAttribute("stateRate", &stateRate);
+			child->QueryBoolAttribute("streamEvents", &Device::streamEvents);
+			if(child->Attribute("stateTable")) {
+				stateTable = std::string(child->Attribute("stateTable"));
+			}
+			child->QueryBoolAttribute("sync", &Device::sync);
+			child->QueryUnsignedAttribute("keyframeInterval", &keyframeInterval);
 			child->QueryBoolAttribute("triggersAsAxes", &GameController::triggersAsAxes);
 			child->QueryBoolAttribute("normalizeAxes", &Device::normalizeAxes);
+			child->QueryBoolAttribute("numericIds", &GameController::numericIds);
+			child->QueryBoolAttribute("inputAddresses", &Device::inputAddresses);
 			child->QueryBoolAttribute("enableSensors", &GameController::enableSensors);
 			unsigned int rate = 0;
 			if(child->QueryUnsignedAttribute("sensorRate", &rate) == XML_SUCCESS && rate > 0) {
@@ -475,6 +1035,5 @@ void App::oscError(int num, const char *msg, const char *where) {
 }
 
 void App::signalExit(int signal) {
-	appPtr->stop();
-	LOG_VERBOSE << std::endl << "	" << PACKAGE << ": signal caught, exiting ..." << std::endl;
+	s_signalCaught = 1;
 }
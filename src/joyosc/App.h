@@ -22,8 +22,11 @@
 ==============================================================================*/
 #pragma once
 
+#include <atomic>
+#include <csignal>
 #include "Common.h"
 #include "DeviceManager.h"
+#include "Coalescer.h"
 
 /// \class App
 /// \brief the main application class
@@ -31,6 +34,13 @@ class App {
 
 	public:
 
+		/// run loop modes
+		enum LoopMode {
+			LOOP_POLL,    ///< poll for events, then sleep for sleepUS
+			LOOP_WAIT,    ///< wait in SDL until an event or wakeup arrives, SDL checks every ms
+			LOOP_ADAPTIVE ///< poll for events, then sleep based on recent activity
+		};
+
 		App();
 
 		/// parse the commandline options & load a config file(s)
@@ -40,7 +50,14 @@ class App {
 		void run();
 
 		/// stop the main loop
-		inline void stop() {m_run = false;}
+		inline void stop() {
+			m_run = false;
+			wake();
+		}
+
+		/// wake the main loop if it is blocked waiting for events,
+		/// safe to call from other threads
+		void wake();
 
 		/// update window with app icon background
 		void updateWindow(SDL_Window *window);
@@ -52,9 +69,10 @@ class App {
 
 		unsigned int listeningPort = 7770; ///< listening port
 		std::string listeningMulticast = ""; ///< multicast listening group, "" if none
+		std::string listeningSocket = ""; ///< unix domain listening socket path, "" if none
 
-		std::string sendingIp = "127.0.0.1"; ///< ip/hostname/multicast group to send to
-		unsigned int sendingPort = 8880; ///< port to send to
+		/// send destinations & filters, the first is the main destination
+		std::vector<DestinationSettings> destinations = std::vector<DestinationSettings>(1);
 
 		bool openWindow = false; ///< open window? helps to receive events on some platforms
 		struct {
@@ -62,9 +80,74 @@ class App {
 			int height = 240;
 		} windowSize; ///< window size on open
 		unsigned int sleepUS = 10000; ///< how long to sleep in the run loop
+		LoopMode loopMode = LOOP_POLL; ///< run loop mode
+		unsigned int sleepFloorUS = 1000; ///< adaptive sleep while events are flowing
+		unsigned int sleepCeilingUS = 50000; ///< max adaptive sleep while inputs are quiet
+		unsigned int deepSleepUS = 500000; ///< adaptive sleep while no devices are open
+		bool sendThread = false; ///< send events from a dedicated thread?
+		unsigned int sendQueueSize = 1024; ///< sender thread queue size in events
+		bool bundle = false; ///< send one bundle per loop iteration?
+		unsigned int bundleMTU = 1472; ///< max bundle size in bytes
+		bool bundleNotifications = false; ///< bundle notifications too?
+		bool bundleReplies = false; ///< bundle query replies too?
+		bool timetags = false; ///< send events in bundles timetagged with the event time?
+		bool realtime = false; ///< lock memory & raise the event thread priority?
+		int realtimePriority = 50; ///< SCHED_FIFO priority in real-time mode
+		int realtimeCPU = -1; ///< cpu core to pin the event thread to, -1 for none
+		unsigned int spinUS = 0; ///< how long to busy poll after events, 0 to disable
+		bool coalesceEvents = false; ///< coalesce motion events per loop iteration?
+		unsigned int stateRate = 0; ///< device state snapshot rate in hz, 0 to disable
+		std::string stateTable = ""; ///< shared memory state table name, "" if none
+		unsigned int keyframeInterval = 1000; ///< keyframe interval in ms when syncing, 0 for on request only
+
+	/// \section static utils
+
+		/// return loop mode name from enum
+		static std::string loopModeName(LoopMode mode);
+
+		/// set loop mode from name: "poll", "wait", or "adaptive",
+		/// returns true on success
+		static bool loopModeForName(const std::string &name, LoopMode &mode);
 
 	protected:
 
+		/// handle an SDL event, forwards device events to the device manager
+		void handleEvent(SDL_Event *event);
+
+		/// handle all pending SDL events, returns true if any were handled
+		bool pollEvents();
+
+		/// busy poll for events until spinUS passes without any
+		void spinEvents();
+
+		/// sleep between event polls based on the loop mode,
+		/// active is true if events were handled this iteration
+		void idle(bool active);
+
+		/// send device state snapshots if due, reschedules the next snapshot
+		void sendStates();
+
+		/// returns micro seconds until the next state snapshot is due,
+		/// 0 if due now or UINT_MAX if snapshots are disabled
+		unsigned int usUntilStates();
+
+		/// send requested keyframes & periodic keyframes if syncing & due
+		void sendKeyframes();
+
+		/// returns micro seconds until the next periodic keyframe is due,
+		/// 0 if due now or UINT_MAX if not syncing or only on request
+		unsigned int usUntilKeyframes();
+
+		/// returns micro seconds until the next state snapshot, keyframe, or
+		/// rate limited record is due, 0 if due now or while opening devices,
+		/// or UINT_MAX if none
+		unsigned int usUntilDue();
+
+		/// try to lock memory, set real-time priority, & pin the calling
+		/// thread to realtimeCPU, warns for each part that fails
+		/// returns true if all parts succeeded
+		bool setupRealtime();
+
 		/// load from an XML file, expects <joyosc> root element
 		/// returns true on success or false on failure
 		bool loadXMLFile(const std::string &path);
@@ -75,13 +158,23 @@ class App {
 		/// osc server error callback
 		static void oscError(int num, const char *msg, const char *where);
 
-		/// signal callback
+		/// signal callback, only sets s_signalCaught as it must be async
+		/// signal safe, the main loop stops once it sees the flag
 		static void signalExit(int signal);
 
-		bool m_run = false; ///< is the main loop running?
+		/// was an exit signal caught?
+		static volatile std::sig_atomic_t s_signalCaught;
+
+		std::atomic<bool> m_run{false}; ///< is the main loop running?
+		Uint32 m_wakeEvent = (Uint32)-1; ///< user event type used to wake the main loop
+		unsigned int m_adaptiveSleepUS = 0; ///< current adaptive sleep time
+		Uint64 m_nextStateTime = 0; ///< next state snapshot time in perf counter ticks
+		Uint64 m_nextKeyframeTime = 0; ///< next periodic keyframe time in perf counter ticks
 
 		DeviceManager m_deviceManager; ///< controller & joystick device manager
+		Coalescer m_coalescer; ///< motion event coalescer, if coalescing
+		StateTable m_stateTable; ///< shared memory device state, if publishing
 
 		lo::ServerThread *m_receiver = nullptr; ///< osc receiver
-		lo::Address *m_sender = nullptr; ///< osc sender
+		Sender *m_sender = nullptr; ///< osc sender
 };
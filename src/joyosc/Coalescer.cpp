@@ -0,0 +1,136 @@
+/*==============================================================================
+
+	Coalescer.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "Coalescer.h"
+
+#include "../shared.h"
+
+Coalescer::Coalescer(size_t size) {
+	m_events.resize(MAX(size, (size_t)1));
+	m_kept.resize(m_events.size());
+	m_latest.reserve(64);
+}
+
+size_t Coalescer::drain() {
+	SDL_PumpEvents();
+	int count = SDL_PeepEvents(m_events.data(), (int)m_events.size(),
+		SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+	if(count <= 0) {
+		return 0;
+	}
+	m_drained += count;
+	coalesce(count);
+	return count;
+}
+
+void Coalescer::print() {
+	LOG << "coalesced events: " << m_coalesced << " of " << m_drained << std::endl;
+}
+
+// PROTECTED
+
+// key: event type | instance id | axis, ball, or touchpad & finger
+uint64_t Coalescer::keyFor(const SDL_Event &event) {
+	switch(event.type) {
+		case SDL_JOYAXISMOTION:
+			return ((uint64_t)event.type << 48) |
+			       ((uint64_t)(uint32_t)event.jaxis.which << 16) |
+			       event.jaxis.axis;
+		case SDL_JOYBALLMOTION:
+			return ((uint64_t)event.type << 48) |
+			       ((uint64_t)(uint32_t)event.jball.which << 16) |
+			       event.jball.ball;
+		case SDL_CONTROLLERAXISMOTION:
+			return ((uint64_t)event.type << 48) |
+			       ((uint64_t)(uint32_t)event.caxis.which << 16) |
+			       event.caxis.axis;
+		case SDL_CONTROLLERTOUCHPADMOTION:
+			return ((uint64_t)event.type << 48) |
+			       ((uint64_t)(uint32_t)event.ctouchpad.which << 16) |
+			       ((event.ctouchpad.touchpad & 0xFF) << 8) |
+			       (event.ctouchpad.finger & 0xFF);
+		default:
+			return 0;
+	}
+}
+
+// keys per drain are few, so a linear search beats a map here
+void Coalescer::coalesce(size_t count) {
+	m_latest.clear();
+	for(size_t i = 0; i < count; ++i) {
+		SDL_Event &event = m_events[i];
+		m_kept[i] = true;
+		uint64_t key = keyFor(event);
+		if(key == 0) {
+			switch(event.type) {
+				case SDL_CONTROLLERTOUCHPADDOWN: case SDL_CONTROLLERTOUCHPADUP: {
+					// finger edge: start a new run of motion for this finger
+					SDL_Event motion = event;
+					motion.type = SDL_CONTROLLERTOUCHPADMOTION;
+					uint64_t fingerKey = keyFor(motion);
+					for(auto iter = m_latest.begin(); iter != m_latest.end(); ++iter) {
+						if(iter->first == fingerKey) {
+							m_latest.erase(iter);
+							break;
+						}
+					}
+					break;
+				}
+				case SDL_JOYDEVICEADDED: case SDL_JOYDEVICEREMOVED:
+				case SDL_CONTROLLERDEVICEADDED: case SDL_CONTROLLERDEVICEREMOVED:
+				case SDL_CONTROLLERDEVICEREMAPPED:
+					// instance ids & mappings may change, don't coalesce across
+					m_latest.clear();
+					break;
+				default:
+					break;
+			}
+			continue;
+		}
+		bool found = false;
+		for(auto &latest : m_latest) {
+			if(latest.first != key) {continue;}
+			SDL_Event &previous = m_events[latest.second];
+			if(event.type == SDL_CONTROLLERAXISMOTION &&
+			   (previous.caxis.value > 0) != (event.caxis.value > 0)) {
+				// crossed zero: triggers sent as buttons press & release
+				// here, so keep the previous value & start a new run
+				latest.second = i;
+				found = true;
+				break;
+			}
+			if(event.type == SDL_JOYBALLMOTION) {
+				// sum relative motion, clamped to the event value range
+				event.jball.xrel = CLAMP((int)previous.jball.xrel + event.jball.xrel, -32768, 32767);
+				event.jball.yrel = CLAMP((int)previous.jball.yrel + event.jball.yrel, -32768, 32767);
+			}
+			m_kept[latest.second] = false;
+			latest.second = i;
+			m_coalesced++;
+			found = true;
+			break;
+		}
+		if(!found) {
+			m_latest.push_back(std::make_pair(key, i));
+		}
+	}
+}
@@ -0,0 +1,79 @@
+/*==============================================================================
+
+	Coalescer.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "Common.h"
+
+/// \class Coalescer
+/// \brief drains the SDL event queue & coalesces redundant motion events
+///
+/// Within each drain, only the latest axis value per device & axis and the
+/// latest touchpad motion per finger are kept, while ball motion is summed.
+/// Kept events stay at the position of their latest occurrence so button,
+/// hat, & touchpad edges are never dropped and stay in order. A touchpad
+/// down or up ends coalescing for that finger & device events end it for
+/// all motion. A game controller axis value crossing zero also ends
+/// coalescing for that axis, so trigger button presses & releases are kept.
+class Coalescer {
+
+	public:
+
+		/// create with the max number of events per drain
+		Coalescer(size_t size=256);
+
+		/// pump & drain pending SDL events into the buffer, then coalesce,
+		/// returns the number of events drained or 0 if there were none
+		size_t drain();
+
+		/// get drained event at index, check isKept() first
+		SDL_Event& event(size_t index) {return m_events[index];}
+
+		/// was the drained event at index kept after coalescing?
+		bool isKept(size_t index) {return m_kept[index];}
+
+		/// number of events drained in total
+		uint64_t drained() {return m_drained;}
+
+		/// number of events dropped as they were coalesced in total
+		uint64_t coalesced() {return m_coalesced;}
+
+		/// print event counters
+		void print();
+
+	protected:
+
+		/// returns a coalescing key for motion events or 0 if the
+		/// event must be kept as is
+		static uint64_t keyFor(const SDL_Event &event);
+
+		/// coalesce the first count events in the buffer
+		void coalesce(size_t count);
+
+		std::vector<SDL_Event> m_events; ///< drained events
+		std::vector<bool> m_kept; ///< keep event at index?
+		std::vector<std::pair<uint64_t,size_t>> m_latest; ///< key -> latest index
+		uint64_t m_drained = 0; ///< total drained event count
+		uint64_t m_coalesced = 0; ///< total coalesced event count
+};
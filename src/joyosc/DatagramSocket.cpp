@@ -0,0 +1,259 @@
+/*==============================================================================
+
+	DatagramSocket.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "DatagramSocket.h"
+
+#ifdef HAVE_SENDMMSG
+
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/un.h>
+#include "Log.h"
+#include "joyosc_frame.h"
+
+DatagramSocket::DatagramSocket(size_t bufferSize, size_t maxDatagrams) {
+	m_buffer.resize(bufferSize);
+	m_iovecs.resize(maxDatagrams);
+	m_headers.resize(maxDatagrams);
+	m_messages.resize(maxDatagrams);
+	memset(&m_address, 0, sizeof(m_address));
+}
+
+DatagramSocket::~DatagramSocket() {
+	close();
+}
+
+bool DatagramSocket::open(const std::string &host, unsigned int port) {
+	close();
+	struct addrinfo hints, *result = nullptr;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	std::string service = std::to_string(port);
+	int ret = getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+	if(ret != 0 || !result) {
+		LOG_WARN << "DatagramSocket: could not resolve " << host << ":" << port
+		         << ": " << gai_strerror(ret) << std::endl;
+		return false;
+	}
+	m_socket = socket(result->ai_family, SOCK_DGRAM, 0);
+	if(m_socket < 0) {
+		LOG_WARN << "DatagramSocket: could not create socket: "
+		         << strerror(errno) << std::endl;
+		freeaddrinfo(result);
+		return false;
+	}
+	int broadcast = 1; // match liblo, allows sending to broadcast addresses
+	setsockopt(m_socket, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+	memcpy(&m_address, result->ai_addr, result->ai_addrlen);
+	m_addressLength = result->ai_addrlen;
+	freeaddrinfo(result);
+	return true;
+}
+
+// the receiver binds the path, sends fail with ENOENT or ECONNREFUSED until
+// it is running
+bool DatagramSocket::openUnix(const std::string &path) {
+	close();
+	struct sockaddr_un *address = (struct sockaddr_un *)&m_address;
+	if(path.size() >= sizeof(address->sun_path)) {
+		LOG_WARN << "DatagramSocket: socket path too long: " << path << std::endl;
+		return false;
+	}
+	m_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if(m_socket < 0) {
+		LOG_WARN << "DatagramSocket: could not create unix socket: "
+		         << strerror(errno) << std::endl;
+		return false;
+	}
+	memset(&m_address, 0, sizeof(m_address));
+	address->sun_family = AF_UNIX;
+	strncpy(address->sun_path, path.c_str(), sizeof(address->sun_path) - 1);
+	m_addressLength = sizeof(struct sockaddr_un);
+	return true;
+}
+
+void DatagramSocket::close() {
+	if(m_socket >= 0) {
+		::close(m_socket);
+		m_socket = -1;
+	}
+	m_used = 0;
+	m_count = 0;
+	m_bundle = false;
+	m_frame = false;
+	m_blocked = false;
+}
+
+bool DatagramSocket::add(const char *data, size_t size) {
+	m_bundle = false;
+	char *dest = beginDatagram(size);
+	if(!dest) {return false;}
+	memcpy(dest, data, size);
+	m_iovecs[m_count - 1].iov_len = size;
+	m_used += size;
+	m_messages[m_count - 1] = 1;
+	return true;
+}
+
+// bundle: "#bundle\0", 8 byte timetag, then size prefixed elements
+bool DatagramSocket::bundle(const char *data, size_t size, size_t mtu, lo_timetag timetag) {
+	size_t elementSize = size + 4;
+	if(m_bundle) {
+		struct iovec &iov = m_iovecs[m_count - 1];
+		if(iov.iov_len + elementSize > mtu || m_used + elementSize > m_buffer.size() ||
+		   timetag.sec != m_timetag.sec || timetag.frac != m_timetag.frac) {
+			m_bundle = false;
+		}
+	}
+	if(!m_bundle) {
+		char *dest = beginDatagram(16 + elementSize);
+		if(!dest) {return false;}
+		memcpy(dest, "#bundle\0", 8);
+		OscMessage::writeInt32(dest + 8, timetag.sec);
+		OscMessage::writeInt32(dest + 12, timetag.frac);
+		m_iovecs[m_count - 1].iov_len = 16;
+		m_used += 16;
+		m_messages[m_count - 1] = 0;
+		m_bundle = true;
+		m_timetag = timetag;
+	}
+	char *dest = m_buffer.data() + m_used;
+	OscMessage::writeInt32(dest, (uint32_t)size);
+	memcpy(dest + 4, data, size);
+	m_iovecs[m_count - 1].iov_len += elementSize;
+	m_used += elementSize;
+	m_messages[m_count - 1]++;
+	return true;
+}
+
+// frame datagram: 16 byte header, then fixed size records, the header count
+// is updated as records are added
+bool DatagramSocket::frame(const char *data, size_t size, size_t mtu) {
+	if(m_frame) {
+		struct iovec &iov = m_iovecs[m_count - 1];
+		if(iov.iov_len + size > mtu || m_used + size > m_buffer.size() ||
+		   m_messages[m_count - 1] >= UINT16_MAX) {
+			m_frame = false;
+		}
+	}
+	if(!m_frame) {
+		char *dest = beginDatagram(JOYOSC_FRAME_HEADER_SIZE + size);
+		if(!dest) {return false;}
+		joyosc_frame_write_header(dest, 0, m_frameSequence++);
+		m_iovecs[m_count - 1].iov_len = JOYOSC_FRAME_HEADER_SIZE;
+		m_used += JOYOSC_FRAME_HEADER_SIZE;
+		m_messages[m_count - 1] = 0;
+		m_frame = true;
+	}
+	struct iovec &iov = m_iovecs[m_count - 1];
+	memcpy(m_buffer.data() + m_used, data, size);
+	iov.iov_len += size;
+	m_used += size;
+	m_messages[m_count - 1]++;
+	joyosc_frame_put16((char *)iov.iov_base + 8, (uint16_t)m_messages[m_count - 1]);
+	return true;
+}
+
+// a blocked send keeps the unsent datagrams instead of waiting, they are
+// moved to the front of the buffer & sent first on the next flush
+void DatagramSocket::flush() {
+	m_bundle = false;
+	m_frame = false;
+	m_blocked = false;
+	if(m_count == 0) {return;}
+	size_t sent = 0;
+	while(m_socket >= 0 && sent < m_count) {
+		int ret = sendmmsg(m_socket, &m_headers[sent], m_count - sent, MSG_DONTWAIT);
+		syscalls++;
+		if(ret < 0) {
+			if(errno == EINTR) {continue;}
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				m_blocked = true;
+				break;
+			}
+			// drop the failed datagram & keep going, ie. ECONNREFUSED
+			LOG_DEBUG << "DatagramSocket: send failed: " << strerror(errno) << std::endl;
+			errors++;
+			sent++;
+			continue;
+		}
+		datagramsSent += ret;
+		sent += ret;
+	}
+	if(!m_blocked) {
+		sent = m_count; // closed socket drops everything
+	}
+	for(size_t i = 0; i < sent; ++i) {
+		messagesSent += m_messages[i];
+	}
+	if(sent == m_count) {
+		m_used = 0;
+		m_count = 0;
+		return;
+	}
+	if(sent == 0) {return;}
+	char *begin = (char *)m_iovecs[sent].iov_base;
+	size_t offset = begin - m_buffer.data();
+	m_used -= offset;
+	memmove(m_buffer.data(), begin, m_used);
+	for(size_t i = sent; i < m_count; ++i) {
+		size_t j = i - sent;
+		m_iovecs[j].iov_base = (char *)m_iovecs[i].iov_base - offset;
+		m_iovecs[j].iov_len = m_iovecs[i].iov_len;
+		m_headers[j] = m_headers[i];
+		m_headers[j].msg_hdr.msg_iov = &m_iovecs[j];
+		m_messages[j] = m_messages[i];
+	}
+	m_count -= sent;
+}
+
+// PROTECTED
+
+char* DatagramSocket::beginDatagram(size_t size) {
+	if(size > m_buffer.size()) {
+		return nullptr;
+	}
+	if(m_count >= m_iovecs.size() || m_used + size > m_buffer.size()) {
+		flush();
+		if(m_count >= m_iovecs.size() || m_used + size > m_buffer.size()) {
+			return nullptr; // blocked, no room
+		}
+	}
+	m_bundle = false;
+	m_frame = false;
+	struct iovec &iov = m_iovecs[m_count];
+	iov.iov_base = m_buffer.data() + m_used;
+	iov.iov_len = 0;
+	struct mmsghdr &header = m_headers[m_count];
+	memset(&header, 0, sizeof(header));
+	header.msg_hdr.msg_name = &m_address;
+	header.msg_hdr.msg_namelen = m_addressLength;
+	header.msg_hdr.msg_iov = &iov;
+	header.msg_hdr.msg_iovlen = 1;
+	m_count++;
+	return m_buffer.data() + m_used;
+}
+
+#endif
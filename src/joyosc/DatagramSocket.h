@@ -0,0 +1,135 @@
+/*==============================================================================
+
+	DatagramSocket.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include "../config.h"
+
+#ifdef HAVE_SENDMMSG
+
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <lo/lo.h>
+#include "OscMessage.h"
+
+/// \class DatagramSocket
+/// \brief UDP socket which batches OSC packets & sends them with sendmmsg()
+///
+/// Encoded messages are copied into a preallocated buffer, either as single
+/// datagrams or into the current bundle datagram, until flush() sends
+/// all pending datagrams with one system call. The buffer is flushed early
+/// when full. Binary frame records, see joyosc_frame.h, are packed into
+/// frame datagrams the same way.
+///
+/// Sends never block: if the socket would block, ie. a unix domain socket
+/// receiver has stalled, the unsent datagrams are kept for the next flush()
+/// & isBlocked() returns true until they have been sent. Not thread safe.
+///
+/// note: Linux only, requires sendmmsg()
+class DatagramSocket {
+
+	public:
+
+		/// create with buffer size in bytes & max datagrams per flush
+		DatagramSocket(size_t bufferSize=65536, size_t maxDatagrams=64);
+		virtual ~DatagramSocket();
+
+		/// resolve host & open socket, returns true on success
+		bool open(const std::string &host, unsigned int port);
+
+		/// open unix domain datagram socket to send to a socket path,
+		/// returns true on success
+		bool openUnix(const std::string &path);
+
+		/// close socket, drops any pending datagrams
+		void close();
+
+		/// returns true if open
+		inline bool isOpen() {return m_socket >= 0;}
+
+		/// add an encoded message as a single datagram, ends the current bundle
+		/// returns false if the message is too large or if there is no room
+		/// as the socket would block, see isBlocked()
+		bool add(const char *data, size_t size);
+
+		/// add an encoded message to the current bundle, starts a new bundle
+		/// with the given timetag if none, if the timetag differs, or if the
+		/// message would not fit within mtu bytes, returns false if the
+		/// message is too large or if there is no room as the socket would
+		/// block, see isBlocked()
+		bool bundle(const char *data, size_t size, size_t mtu, lo_timetag timetag);
+
+		/// add an encoded binary frame record to the current frame datagram,
+		/// starts a new one if none or if the record would not fit within mtu
+		/// bytes, returns false if there is no room as the socket would block,
+		/// see isBlocked()
+		bool frame(const char *data, size_t size, size_t mtu);
+
+		/// end the current bundle, if any
+		inline void endBundle() {m_bundle = false;}
+
+		/// is there a bundle in progress?
+		inline bool inBundle() {return m_bundle;}
+
+		/// send all pending datagrams without blocking, keeps the unsent
+		/// datagrams if the socket would block
+		void flush();
+
+		/// returns true if the last flush kept datagrams as the socket would block
+		inline bool isBlocked() {return m_blocked;}
+
+		/// number of pending datagrams
+		inline size_t pending() {return m_count;}
+
+	/// \section counters
+
+		uint64_t messagesSent = 0; ///< total messages sent
+		uint64_t datagramsSent = 0; ///< total datagrams sent
+		uint64_t syscalls = 0; ///< total sendmmsg calls
+		uint64_t errors = 0; ///< total send errors
+
+	protected:
+
+		/// start a new datagram with size bytes, ends the current bundle or
+		/// frame datagram & flushes if needed
+		/// returns destination pointer or nullptr if too large or blocked
+		char* beginDatagram(size_t size);
+
+		int m_socket = -1; ///< socket file descriptor
+		struct sockaddr_storage m_address; ///< destination address
+		socklen_t m_addressLength = 0; ///< destination address length
+
+		std::vector<char> m_buffer; ///< encoded datagrams
+		size_t m_used = 0; ///< used buffer bytes
+		std::vector<struct iovec> m_iovecs; ///< datagram buffer ranges
+		std::vector<struct mmsghdr> m_headers; ///< sendmmsg headers
+		std::vector<size_t> m_messages; ///< number of messages per datagram
+		size_t m_count = 0; ///< number of pending datagrams
+		bool m_bundle = false; ///< is the last datagram an open bundle?
+		bool m_frame = false; ///< is the last datagram an open frame datagram?
+		uint32_t m_frameSequence = 0; ///< next frame datagram sequence number
+		bool m_blocked = false; ///< would the socket block on the last flush?
+		lo_timetag m_timetag = {0, 0}; ///< open bundle timetag
+};
+
+#endif
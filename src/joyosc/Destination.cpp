@@ -0,0 +1,602 @@
+/*==============================================================================
+
+	Destination.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "Destination.h"
+
+#include <algorithm>
+#include <cmath>
+#include "Device.h"
+#include "joyosc_frame.h"
+#include "../shared.h"
+
+using namespace tinyxml2;
+
+// DESTINATION SETTINGS
+
+bool DestinationSettings::readXML(XMLElement *e) {
+	if(e->Attribute("name")) {
+		name = std::string(e->Attribute("name"));
+	}
+	if(e->Attribute("ip")) {
+		ip = std::string(e->Attribute("ip"));
+	}
+	e->QueryUnsignedAttribute("port", &port);
+	if(e->Attribute("socket")) {
+		socket = std::string(e->Attribute("socket"));
+	}
+	if(e->Attribute("protocol")) {
+		std::string protocol(e->Attribute("protocol"));
+		if(protocol == "tcp") {tcp = true;}
+		else if(protocol == "udp") {tcp = false;}
+		else {
+			LOG_WARN << "<sending> unknown protocol: " << protocol << std::endl;
+			return false;
+		}
+	}
+	if(e->Attribute("devices")) {
+		// space or comma separated, leading / optional
+		devices.clear();
+		std::stringstream stream(e->Attribute("devices"));
+		std::string device;
+		while(std::getline(stream, device, ' ')) {
+			std::stringstream list(device);
+			while(std::getline(list, device, ',')) {
+				if(device == "") {continue;}
+				if(device[0] != '/') {device = "/" + device;}
+				devices.push_back(device);
+			}
+		}
+	}
+	if(e->Attribute("types")) {
+		types = 0;
+		std::stringstream stream(e->Attribute("types"));
+		std::string type;
+		while(stream >> type) {
+			if(type == "state") {
+				types |= STATE_TYPE_BIT;
+				continue;
+			}
+			int i = 0;
+			for(; i < EVENT_TYPE_COUNT; ++i) {
+				if(type == Device::eventTypeName((EventType)i)) {
+					types |= typeBit((EventType)i);
+					break;
+				}
+			}
+			if(i == EVENT_TYPE_COUNT) {
+				LOG_WARN << "<sending> unknown type: " << type << std::endl;
+				return false;
+			}
+		}
+	}
+	e->QueryUnsignedAttribute("rate", &rate);
+	e->QueryBoolAttribute("notifications", &notifications);
+	e->QueryBoolAttribute("replies", &replies);
+	e->QueryUnsignedAttribute("queueSize", &queueSize);
+	if(e->Attribute("format")) {
+		std::string format(e->Attribute("format"));
+		if(format == "frames") {frames = true;}
+		else if(format == "osc") {frames = false;}
+		else {
+			LOG_WARN << "<sending> unknown format: " << format << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+std::string DestinationSettings::toString() {
+	std::stringstream s;
+	if(socket != "") {s << "socket " << socket;}
+	else {
+		s << ip << " " << port;
+		if(tcp) {s << " tcp";}
+	}
+	if(frames) {s << " frames";}
+	if(!devices.empty()) {
+		s << " devices:";
+		for(auto &device : devices) {s << " " << device;}
+	}
+	if(types != ALL_TYPE_BITS) {
+		s << " types:";
+		for(int i = 0; i < EVENT_TYPE_COUNT; ++i) {
+			if(types & typeBit((EventType)i)) {
+				s << " " << Device::eventTypeName((EventType)i);
+			}
+		}
+		if(types & STATE_TYPE_BIT) {s << " state";}
+	}
+	if(rate > 0) {s << " rate: " << rate;}
+	if(!notifications) {s << " no notifications";}
+	if(!replies) {s << " no replies";}
+	return s.str();
+}
+
+// DESTINATION
+
+Destination::Destination(const DestinationSettings &settings) :
+	m_settings(settings), m_queue(settings.queueSize) {
+	for(auto &device : m_settings.devices) {
+		m_devices.push_back(Device::internString(device));
+	}
+	m_intervalMS = (m_settings.rate > 0 ? MAX(1000 / m_settings.rate, 1u) : 0); // hz -> ms
+}
+
+Destination::~Destination() {
+#ifndef _WIN32
+	if(m_stream) {
+		delete m_stream;
+		m_stream = nullptr;
+	}
+#endif
+#ifdef HAVE_SENDMMSG
+	if(m_socket) {
+		delete m_socket;
+		m_socket = nullptr;
+	}
+#endif
+	if(m_bundle) {
+		lo_bundle_free_recursive(m_bundle);
+		m_bundle = nullptr;
+	}
+	if(m_address) {
+		delete m_address;
+		m_address = nullptr;
+	}
+}
+
+bool Destination::open() {
+	if(m_settings.socket != "") {
+		return openUnix();
+	}
+	if(m_settings.tcp) {
+#ifndef _WIN32
+		if(!m_stream) {
+			m_stream = new StreamSocket;
+		}
+		if(m_stream->open(m_settings.ip, m_settings.port)) {
+			openFrames();
+			return true;
+		}
+		delete m_stream;
+		m_stream = nullptr;
+		return false;
+#else
+		LOG_WARN << "Destination: " << toString()
+		         << " tcp not supported on this platform, using udp" << std::endl;
+#endif
+	}
+	if(m_address) {delete m_address;}
+	m_address = new lo::Address(m_settings.ip, m_settings.port);
+#ifdef HAVE_SENDMMSG
+	if(!m_socket) {
+		m_socket = new DatagramSocket;
+	}
+	if(!m_socket->open(m_settings.ip, m_settings.port)) {
+		LOG_VERBOSE << "Destination: " << toString()
+		            << " falling back to liblo" << std::endl;
+		delete m_socket;
+		m_socket = nullptr;
+	}
+#endif
+	openFrames();
+	return m_address != nullptr;
+}
+
+bool Destination::openUnix() {
+#ifdef _WIN32
+	LOG_WARN << "Destination: " << toString()
+	         << " unix domain sockets not supported on this platform" << std::endl;
+	return false;
+#else
+	if(m_settings.tcp) {
+		LOG_WARN << "Destination: " << toString()
+		         << " ignoring tcp, unix domain sockets send datagrams" << std::endl;
+	}
+	if(m_address) {delete m_address;}
+	m_address = new lo::Address("", m_settings.socket, LO_UNIX);
+#ifdef HAVE_SENDMMSG
+	if(!m_socket) {
+		m_socket = new DatagramSocket;
+	}
+	if(!m_socket->openUnix(m_settings.socket)) {
+		LOG_VERBOSE << "Destination: " << toString()
+		            << " falling back to liblo" << std::endl;
+		delete m_socket;
+		m_socket = nullptr;
+	}
+#endif
+	openFrames();
+	return m_address != nullptr;
+#endif
+}
+
+bool Destination::accepts(const EventRecord &record) {
+	if(!(m_settings.types & DestinationSettings::typeBit(record.type)) ||
+	   !acceptsDevice(record.address)) {
+		return false;
+	}
+	if(m_intervalMS == 0 && m_flowRate == 0) {return true;}
+	HeldKey key;
+	if(!isLimited(record, key)) {
+		if(record.type == TOUCHPAD) {
+			// down & up carry the final position, drop any held motion
+			auto it = m_held.find(key);
+			if(it != m_held.end()) {it->second.held = false;}
+		}
+		return true;
+	}
+	auto it = m_held.find(key);
+	if(it == m_held.end()) {
+		// first event for this input, due now
+		Held held;
+		held.sent = record.timestamp - m_intervalMS;
+		it = m_held.insert(std::make_pair(key, held)).first;
+	}
+	Held &held = it->second;
+	if(!held.held && record.timestamp - held.sent >= m_intervalMS &&
+	   takeCredit(record.timestamp)) {
+		held.sent = record.timestamp;
+		return true;
+	}
+	if(held.held && record.type == BALL) {
+		// relative motion, keep the sum
+		held.record.ivalues[0] += record.ivalues[0];
+		held.record.ivalues[1] += record.ivalues[1];
+	}
+	else {
+		held.record = record;
+	}
+	held.held = true;
+	uint32_t at = held.sent + m_intervalMS;
+	if(m_flowRate > 0 && (int32_t)(creditDue() - at) > 0) {
+		at = creditDue(); // wait for a credit
+	}
+	m_heldDue = earlier(m_heldDue, at);
+	return false;
+}
+
+bool Destination::acceptsState(const char *address) {
+	return (m_settings.types & STATE_TYPE_BIT) && acceptsDevice(address);
+}
+
+void Destination::takeHeld(uint32_t now, std::vector<EventRecord> &due) {
+	if(m_heldDue == 0 || (int32_t)(now - m_heldDue) < 0) {return;}
+	uint32_t next = 0;
+	m_ready.clear();
+	for(auto &it : m_held) {
+		Held &held = it.second;
+		if(!held.held) {continue;}
+		uint32_t at = held.sent + m_intervalMS;
+		if((int32_t)(now - at) >= 0) {
+			m_ready.push_back(&held);
+		}
+		else {
+			next = earlier(next, at);
+		}
+	}
+	if(m_flowRate > 0) {
+		// longest waiting first so every input gets its share of the credits
+		std::sort(m_ready.begin(), m_ready.end(), [](const Held *a, const Held *b) {
+			return (int32_t)(a->sent - b->sent) < 0;
+		});
+	}
+	for(Held *held : m_ready) {
+		if(!takeCredit(now)) {
+			next = earlier(next, creditDue());
+			break;
+		}
+		due.push_back(held->record);
+		held->sent = now;
+		held->held = false;
+	}
+	m_heldDue = next;
+}
+
+// allow bursts of up to 50 ms worth of credits, ie. a few run loop iterations
+void Destination::setFlow(unsigned int rate) {
+	m_flowRate = rate;
+	m_maxCredits = MAX(rate / 20.f, 1.f);
+	m_credits = m_maxCredits;
+	m_creditTime = SDL_GetTicks();
+	if(!m_held.empty()) {
+		// recheck held inputs with the new rate
+		m_heldDue = m_creditTime;
+	}
+}
+
+// once the socket would block, everything is queued until the next flush
+// so queued packets are never overtaken by newer ones
+void Destination::output(OscPacket &packet, bool bundled, size_t mtu, lo_timetag timetag) {
+	if(m_frames && packet.record && !packet.frame) {
+		char data[JOYOSC_FRAME_RECORD_SIZE];
+		OscPacket frame(packet.path, data, encodeFrame(*packet.record, data));
+		frame.record = packet.record;
+		frame.frame = true;
+		output(frame, bundled, mtu, timetag);
+		return;
+	}
+	if(m_blocked || !write(packet, bundled, mtu, timetag)) {
+		m_blocked = true;
+		queue(packet, bundled, mtu, timetag);
+	}
+}
+
+void Destination::flush() {
+	m_blocked = flushSocket();
+	if(m_blocked || m_queue.empty()) {return;}
+
+	// the socket takes data again, send the oldest first until it would
+	// block again
+	while(SendQueue::Entry *entry = m_queue.front()) {
+		OscPacket packet(entry->path.c_str(), entry->data.data(), entry->data.size());
+		packet.frame = entry->frame;
+		if(!write(packet, entry->bundled, entry->mtu, entry->timetag)) {break;}
+		m_queue.pop();
+	}
+	m_blocked = flushSocket();
+}
+
+bool Destination::isPending() {
+	if(!m_queue.empty()) {return true;}
+#ifndef _WIN32
+	if(m_stream) {return m_stream->pending() > 0;}
+#endif
+	return false;
+}
+
+uint64_t Destination::messagesSent() {
+#ifndef _WIN32
+	if(m_stream) {return m_stream->messagesSent;}
+#endif
+#ifdef HAVE_SENDMMSG
+	if(m_socket) {return m_socket->messagesSent;}
+#endif
+	return m_messagesSent;
+}
+
+uint64_t Destination::packetsSent() {
+#ifndef _WIN32
+	if(m_stream) {return m_stream->framesSent;}
+#endif
+#ifdef HAVE_SENDMMSG
+	if(m_socket) {return m_socket->datagramsSent;}
+#endif
+	return m_packetsSent;
+}
+
+uint64_t Destination::sendCalls() {
+#ifndef _WIN32
+	if(m_stream) {return m_stream->writes;}
+#endif
+#ifdef HAVE_SENDMMSG
+	if(m_socket) {return m_socket->syscalls;}
+#endif
+	return m_packetsSent; // one call per packet
+}
+
+std::string Destination::toString() {
+	return (m_settings.name == "" ? "main" : m_settings.name);
+}
+
+// PROTECTED
+
+// frames are written into batched datagrams, liblo only sends OSC
+void Destination::openFrames() {
+	m_frames = false;
+	if(!m_settings.frames) {return;}
+#ifdef HAVE_SENDMMSG
+	m_frames = (m_socket != nullptr);
+#endif
+	if(!m_frames) {
+		LOG_WARN << "Destination: " << toString()
+		         << " binary frames require udp or a unix domain socket on Linux, "
+		         << "sending OSC" << std::endl;
+	}
+}
+
+// frame types match the event types
+static_assert(JOYOSC_FRAME_SENSOR == SENSOR, "frame & event types differ");
+
+// record ids are resolved when the device compiles its inputs
+size_t Destination::encodeFrame(const EventRecord &record, char *dest) {
+	joyosc_frame_record frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.time = record.timestamp;
+	frame.sequence = record.sequence;
+	frame.time_us = (uint16_t)record.timestampUS;
+	frame.device = (uint16_t)record.device;
+	frame.type = (uint8_t)record.type;
+	frame.id = (int16_t)record.id;
+	switch(record.type) {
+		case BUTTON:
+			frame.values[0].i = record.ivalues[0];
+			break;
+		case AXIS:
+			if(record.isFloat) {
+				frame.flags = JOYOSC_FRAME_FLOAT;
+				frame.values[0].f = record.fvalues[0];
+			}
+			else {
+				frame.values[0].i = record.ivalues[0];
+			}
+			break;
+		case BALL:
+			frame.values[0].i = record.ivalues[0];
+			frame.values[1].i = record.ivalues[1];
+			break;
+		case HAT:
+			frame.values[0].i = record.ivalues[0];
+			break;
+		case TOUCHPAD:
+			switch(record.id) {
+				case SDL_CONTROLLERTOUCHPADDOWN: frame.id = JOYOSC_FRAME_TOUCH_DOWN; break;
+				case SDL_CONTROLLERTOUCHPADUP: frame.id = JOYOSC_FRAME_TOUCH_UP; break;
+				default: frame.id = JOYOSC_FRAME_TOUCH_MOTION; break;
+			}
+			frame.touchpad = (int16_t)record.ivalues[0];
+			frame.finger = (int16_t)record.ivalues[1];
+			// fallthrough
+		case SENSOR:
+			frame.flags = JOYOSC_FRAME_FLOAT;
+			frame.values[0].f = record.fvalues[0];
+			frame.values[1].f = record.fvalues[1];
+			frame.values[2].f = record.fvalues[2];
+			break;
+	}
+	joyosc_frame_write(dest, &frame);
+	return JOYOSC_FRAME_RECORD_SIZE;
+}
+
+// device address pointers are interned, so compare pointers
+bool Destination::acceptsDevice(const char *address) {
+	if(m_devices.empty()) {return true;}
+	for(const char *device : m_devices) {
+		if(device == address) {return true;}
+	}
+	return false;
+}
+
+bool Destination::isLimited(const EventRecord &record, HeldKey &key) {
+	switch(record.type) {
+		case AXIS:
+			key = HeldKey(record.path, (record.name ? (intptr_t)record.name : record.id));
+			return true;
+		case BALL: case SENSOR:
+			key = HeldKey(record.path, record.id);
+			return true;
+		case TOUCHPAD:
+			key = HeldKey(record.path, (record.ivalues[0] << 16) | record.ivalues[1]);
+			return record.id == SDL_CONTROLLERTOUCHPADMOTION;
+		default:
+			return false;
+	}
+}
+
+// credits refill continuously, so a consumer which can take 100 messages per
+// second gets one every 10 ms on average
+bool Destination::takeCredit(uint32_t now) {
+	if(m_flowRate == 0) {return true;}
+	if((int32_t)(now - m_creditTime) > 0) {
+		m_credits = MIN(m_credits + (now - m_creditTime) * m_flowRate / 1000.f, m_maxCredits);
+		m_creditTime = now;
+	}
+	if(m_credits < 1) {return false;}
+	m_credits -= 1;
+	return true;
+}
+
+uint32_t Destination::creditDue() {
+	if(m_flowRate == 0 || m_credits >= 1) {return m_creditTime;}
+	return m_creditTime + MAX((uint32_t)ceilf((1 - m_credits) * 1000 / m_flowRate), 1u);
+}
+
+bool Destination::write(OscPacket &packet, bool bundled, size_t mtu, lo_timetag timetag) {
+#ifndef _WIN32
+	if(m_stream) {
+		// no mtu, a bundle frame can be any size
+		bool written = (bundled ? m_stream->bundle(packet.data, packet.size, timetag) :
+		                          m_stream->add(packet.data, packet.size));
+		return written || !m_stream->isBlocked();
+	}
+#endif
+#ifdef HAVE_SENDMMSG
+	if(m_socket) {
+		if(packet.frame) {
+			return m_socket->frame(packet.data, packet.size, mtu) || !m_socket->isBlocked();
+		}
+		bool written = (bundled ? m_socket->bundle(packet.data, packet.size, mtu, timetag) :
+		                          m_socket->add(packet.data, packet.size));
+		return written || !m_socket->isBlocked();
+	}
+#endif
+	lo_message message = packet.message();
+	if(!message) {return true;}
+	if(bundled) {
+		bundleMessage(packet.path, message, mtu, timetag);
+	}
+	else {
+		lo_send_message(*m_address, packet.path, message);
+		m_messagesSent++;
+		m_packetsSent++;
+	}
+	return true;
+}
+
+// trackball motion is relative & can not be replaced, so only axes, touchpad
+// motion, & sensors are conflated
+void Destination::queue(OscPacket &packet, bool bundled, size_t mtu, lo_timetag timetag) {
+	HeldKey key;
+	bool continuous = (packet.record && packet.record->type != BALL &&
+	                   isLimited(*packet.record, key));
+	SendQueue::Entry *entry = m_queue.push(continuous ? &key : nullptr);
+	if(!entry) {return;}
+	entry->path = packet.path;
+	entry->data.assign(packet.data, packet.data + packet.size);
+	entry->bundled = bundled;
+	entry->frame = packet.frame;
+	entry->mtu = mtu;
+	entry->timetag = timetag;
+}
+
+bool Destination::flushSocket() {
+#ifndef _WIN32
+	if(m_stream) {
+		m_stream->flush();
+		return m_stream->isBlocked();
+	}
+#endif
+#ifdef HAVE_SENDMMSG
+	if(m_socket) {
+		m_socket->flush();
+		return m_socket->isBlocked();
+	}
+#endif
+	sendBundle();
+	return false;
+}
+
+// bundle element sizes are prefixed by a 4 byte length
+void Destination::bundleMessage(const char *path, lo_message message, size_t mtu, lo_timetag timetag) {
+	size_t size = lo_message_length(message, path) + 4;
+	if(m_bundle && (m_bundleSize + size > mtu ||
+	   timetag.sec != m_bundleTimetag.sec || timetag.frac != m_bundleTimetag.frac)) {
+		sendBundle();
+	}
+	if(!m_bundle) {
+		m_bundle = lo_bundle_new(timetag);
+		m_bundleSize = 16; // "#bundle" & timetag
+		m_bundleTimetag = timetag;
+	}
+	lo_bundle_add_message(m_bundle, path, message);
+	m_bundleSize += size;
+}
+
+void Destination::sendBundle() {
+	if(!m_bundle) {return;}
+	m_messagesSent += lo_bundle_count(m_bundle);
+	m_packetsSent++;
+	lo_send_bundle(*m_address, m_bundle);
+	lo_bundle_free_recursive(m_bundle); // also releases the messages
+	m_bundle = nullptr;
+	m_bundleSize = 0;
+}
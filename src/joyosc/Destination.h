@@ -0,0 +1,278 @@
+/*==============================================================================
+
+	Destination.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include <map>
+#include <vector>
+#include "Common.h"
+#include "Event.h"
+#include "DatagramSocket.h"
+#include "StreamSocket.h"
+#include "SendQueue.h"
+
+/// event type filter bit for device state snapshots
+#define STATE_TYPE_BIT (1 << EVENT_TYPE_COUNT)
+
+/// event type filter bits for all event types & state snapshots
+#define ALL_TYPE_BITS ((1 << (EVENT_TYPE_COUNT + 1)) - 1)
+
+/// send destination settings & event filters
+struct DestinationSettings {
+	std::string name = ""; ///< destination name, "" for the main destination
+	std::string ip = "127.0.0.1"; ///< ip/hostname/multicast group to send to
+	unsigned int port = 8880; ///< port to send to
+	bool tcp = false; ///< send over TCP with SLIP framing? otherwise UDP
+	std::string socket = ""; ///< unix domain socket path to send to instead, "" if none
+	std::vector<std::string> devices; ///< device addresses to send, all if empty
+	unsigned int types = ALL_TYPE_BITS; ///< event types to send, see typeBit()
+	unsigned int rate = 0; ///< max rate in hz per continuous input, 0 for unlimited
+	bool notifications = true; ///< send notifications?
+	bool replies = true; ///< send query replies?
+	unsigned int queueSize = 256; ///< max queued messages while the socket would block, 0 to drop
+	bool frames = false; ///< send events as binary frame records? see joyosc_frame.h
+
+	/// load from a <sending> XML element, only sets attributes which exist
+	/// returns false on an invalid attribute
+	bool readXML(tinyxml2::XMLElement *e);
+
+	/// returns settings as a string, ie. "127.0.0.1 8880 types: button"
+	std::string toString();
+
+	/// returns true if any filter is set
+	inline bool isFiltered() {
+		return !devices.empty() || types != ALL_TYPE_BITS || rate > 0 ||
+		       !notifications || !replies;
+	}
+
+	/// returns the filter bit for an event type
+	inline static unsigned int typeBit(EventType type) {return 1 << type;}
+};
+
+/// \struct OscPacket
+/// \brief an encoded OSC message which is shared by all destinations
+///
+/// The liblo message is only decoded if a destination needs it, ie. there
+/// is no batched socket, and is released with the packet.
+struct OscPacket {
+	const char *path = nullptr; ///< message path
+	const char *data = nullptr; ///< encoded message, nullptr if only frames are sent
+	size_t size = 0; ///< encoded message size in bytes
+	const EventRecord *record = nullptr; ///< event record, if encoded from one
+	bool frame = false; ///< is the data a binary frame record instead?
+
+	OscPacket(const char *path, const char *data, size_t size) :
+		path(path), data(data), size(size) {}
+	~OscPacket() {
+		if(m_message) {lo_message_free(m_message);}
+	}
+
+	/// returns the decoded liblo message or nullptr on error
+	lo_message message() {
+		if(!m_message) {
+			m_message = lo_message_deserialise((void *)data, size, nullptr);
+			if(m_message) {lo_message_incref(m_message);}
+		}
+		return m_message;
+	}
+
+	private:
+		lo_message m_message = nullptr; ///< decoded liblo message, if any
+};
+
+/// \class Destination
+/// \brief an OSC send destination with event filters
+///
+/// Events are filtered by device address & input type. Continuous inputs,
+/// ie. axes, balls, touchpad motion, & sensors, can be rate limited per
+/// input: events within the rate interval are held & the latest value is
+/// sent once the interval has passed so the final value is never lost. Held
+/// ball motion is accumulated.
+///
+/// A consumer can also set a flow limit for all of its continuous inputs in
+/// messages per second: each continuous message takes a credit, refilled at
+/// the flow rate, & inputs without a credit are held the same way, so the
+/// output is decimated instead of randomly lost. Held inputs which waited
+/// the longest get the next credits.
+///
+/// While the batched or TCP socket would block, output goes into a bounded
+/// SendQueue which conflates axis, touchpad motion, & sensor updates per
+/// input & is sent on flush() once the socket takes data again.
+///
+/// With binary frames, event records are packed into frame datagrams instead
+/// of being sent as OSC messages, see joyosc_frame.h. Other messages are
+/// still sent as OSC. Requires the batched socket, otherwise OSC is sent.
+///
+/// Not thread safe, the Sender serializes access.
+class Destination {
+
+	public:
+
+		Destination(const DestinationSettings &settings);
+		virtual ~Destination();
+
+		/// create OSC address & batched or TCP socket, returns true on success
+		bool open();
+
+		/// returns true if the record should be sent now, false if it is
+		/// filtered out or held by the rate limit
+		bool accepts(const EventRecord &record);
+
+		/// returns true if a state snapshot for a device address should be sent
+		bool acceptsState(const char *address);
+
+		/// take held records which are due at now ms, see SDL_GetTicks(),
+		/// & add them to due
+		void takeHeld(uint32_t now, std::vector<EventRecord> &due);
+
+		/// returns the earliest held record due time in ms or 0 if none
+		inline uint32_t heldDue() {return m_heldDue;}
+
+		/// set the consumer flow limit for continuous inputs in messages per
+		/// second, 0 for unlimited
+		void setFlow(unsigned int rate);
+
+		/// get the consumer flow limit in messages per second, 0 if unlimited
+		inline unsigned int getFlow() {return m_flowRate;}
+
+		/// send or bundle a packet, queued if the socket would block
+		/// note: sent packets may wait for flush() if batching
+		void output(OscPacket &packet, bool bundled, size_t mtu, lo_timetag timetag);
+
+		/// send the current bundle or batched datagrams, if any, then queued
+		/// packets once the socket takes data again
+		void flush();
+
+		/// returns true if output is waiting to be sent, ie. while a TCP
+		/// destination is reconnecting or packets are queued
+		bool isPending();
+
+		/// returns true if events are sent as binary frame records
+		inline bool isFrames() {return m_frames;}
+
+		/// get the queue of packets waiting while the socket would block
+		inline const SendQueue& getQueue() {return m_queue;}
+
+		/// get settings
+		inline const DestinationSettings& getSettings() {return m_settings;}
+
+		/// number of messages sent
+		uint64_t messagesSent();
+
+		/// number of packets sent, ie. datagrams, bundles, or TCP frames
+		uint64_t packetsSent();
+
+		/// number of send system calls
+		uint64_t sendCalls();
+
+		/// returns destination name for printing, "main" for the main destination
+		std::string toString();
+
+		/// returns the earlier of two due times in ms, ignores 0 for none
+		inline static uint32_t earlier(uint32_t a, uint32_t b) {
+			if(a == 0) {return b;}
+			if(b == 0) {return a;}
+			return ((int32_t)(a - b) < 0 ? a : b);
+		}
+
+	protected:
+
+		/// rate limited input
+		struct Held {
+			EventRecord record; ///< latest held record
+			uint32_t sent = 0; ///< last sent time in ms
+			bool held = false; ///< is a record waiting?
+		};
+
+		/// rate limit key: send path & input id or name, the path pointer
+		/// identifies the device & type as paths are interned
+		typedef std::pair<const char *, intptr_t> HeldKey;
+
+		/// create OSC address & batched socket for a unix domain socket path,
+		/// returns true on success
+		bool openUnix();
+
+		/// enable binary frames if set & the batched socket is open
+		void openFrames();
+
+		/// encode an event record as a binary frame record into dest,
+		/// returns size in bytes, see joyosc_frame.h
+		static size_t encodeFrame(const EventRecord &record, char *dest);
+
+		/// returns true if the device address passes the device filter
+		bool acceptsDevice(const char *address);
+
+		/// returns true if the record is rate limited, sets key
+		bool isLimited(const EventRecord &record, HeldKey &key);
+
+		/// take a flow credit at now ms, returns false if none are available
+		bool takeCredit(uint32_t now);
+
+		/// returns the time in ms when the next flow credit is available
+		uint32_t creditDue();
+
+		/// send or bundle a packet to the socket,
+		/// returns false if refused as the socket would block
+		bool write(OscPacket &packet, bool bundled, size_t mtu, lo_timetag timetag);
+
+		/// add a packet to the queue, conflated per input if continuous
+		void queue(OscPacket &packet, bool bundled, size_t mtu, lo_timetag timetag);
+
+		/// send the current bundle or batched datagrams, if any,
+		/// returns true if the socket would block
+		bool flushSocket();
+
+		/// add message to the current liblo bundle, sends the bundle first if
+		/// the message would not fit or the timetag differs
+		void bundleMessage(const char *path, lo_message message, size_t mtu, lo_timetag timetag);
+
+		/// send & clear the current liblo bundle
+		void sendBundle();
+
+		DestinationSettings m_settings; ///< settings & filters
+		std::vector<const char *> m_devices; ///< interned device addresses
+		uint32_t m_intervalMS = 0; ///< rate limit interval, 0 for unlimited
+		std::map<HeldKey, Held> m_held; ///< rate limited inputs
+		uint32_t m_heldDue = 0; ///< earliest held record due time, 0 if none
+		std::vector<Held *> m_ready; ///< due held inputs, reused
+
+		unsigned int m_flowRate = 0; ///< flow limit in messages per second, 0 for unlimited
+		float m_credits = 0; ///< available flow credits
+		float m_maxCredits = 0; ///< max flow credits, limits bursts
+		uint32_t m_creditTime = 0; ///< last flow credit refill time in ms
+		SendQueue m_queue; ///< packets waiting while the socket would block
+		bool m_blocked = false; ///< would the socket block? queue until flush
+		bool m_frames = false; ///< send events as binary frame records?
+
+		lo::Address *m_address = nullptr; ///< OSC address to send to
+#ifdef HAVE_SENDMMSG
+		DatagramSocket *m_socket = nullptr; ///< batched socket, if open
+#endif
+#ifndef _WIN32
+		StreamSocket *m_stream = nullptr; ///< TCP socket, if sending over TCP
+#endif
+		lo_bundle m_bundle = nullptr; ///< current liblo bundle, if any
+		size_t m_bundleSize = 0; ///< current liblo bundle size in bytes
+		lo_timetag m_bundleTimetag = {0, 0}; ///< current liblo bundle timetag
+		uint64_t m_messagesSent = 0; ///< liblo messages sent
+		uint64_t m_packetsSent = 0; ///< liblo packets sent
+};
@@ -22,21 +22,44 @@
 ==============================================================================*/
 #include "Device.h"
 
+#include <mutex>
 #include "../shared.h"
 
 std::string Device::deviceAddress = "/" PACKAGE "/devices";
 const std::string Device::receiveAddress = "/" PACKAGE "/devices";
 bool Device::printEvents = false;
-lo::Address* Device::sender = nullptr;
+bool Device::streamEvents = true;
+bool Device::sync = false;
+Sender* Device::sender = nullptr;
+StateTable* Device::stateTable = nullptr;
 
 bool Device::normalizeAxes = false;
+bool Device::inputAddresses = false;
 
-Device::Device(std::string address) : m_address(address) {
+Device::Device(std::string address) {
+	setAddress(address);
 	m_normalizeAxes = Device::normalizeAxes;
+	m_inputAddresses = Device::inputAddresses;
+}
+
+void Device::setAddress(const std::string &address) {
+	m_address = address;
+	updateSendPaths();
+}
+
+void Device::updateSendPaths() {
+	std::string base = deviceAddress + m_address + "/";
+	for(int i = 0; i < EVENT_TYPE_COUNT; ++i) {
+		m_sendPaths[i] = internString(base + eventTypeName((EventType)i));
+	}
+	m_statePath = internString(base + "state");
+	m_keyframePath = internString(base + "keyframe");
+	m_sendAddress = internString(m_address);
+	addInputPaths();
 }
 
 void Device::setAxisDeadZone(unsigned int zone) {
-	m_axisDeadZone = zone;
+	m_state->axisDeadZone = (int32_t)zone;
 	LOG_DEBUG << toString() << " \"" << getName() << "\": "
 	          << "set axis dead zone to " << zone << std::endl;
 }
@@ -51,6 +74,13 @@ void Device::setIgnore(EventIgnore *ignore) {
 	if(m_ignore) {m_ignore->check(this);}
 }
 
+void Device::setStateBlock(DeviceState *block) {
+	if(!block) {block = &m_ownState;}
+	if(block == m_state) {return;}
+	*block = *m_state;
+	m_state = block;
+}
+
 void Device::printRemapping() {
 	if(m_remapping) {m_remapping->print();}
 }
@@ -59,6 +89,101 @@ void Device::printIgnores() {
 	if(m_ignore) {m_ignore->print();}
 }
 
+void Device::sendState() {
+	OscMessage message(m_statePath);
+	addState(message);
+	sender->send(message, m_sendAddress);
+}
+
+// the state includes every event up to & including the sequence number
+void Device::sendKeyframe() {
+	OscMessage message(m_keyframePath);
+	message.addInt32((int32_t)m_state->sequence);
+	addState(message);
+	sender->send(message, m_sendAddress);
+}
+
+void Device::addState(OscMessage &message) {
+	message.addInt64((int64_t)m_state->buttons);
+	for(int i = 0; i < m_state->numAxes; ++i) {
+		message.addFloat(normalizeAxisValue(m_state->axes[i]));
+	}
+	for(int i = 0; i < m_state->numHats; ++i) {
+		message.addInt32(m_state->hats[i]);
+	}
+	for(int i = 0; i < DEVICE_STATE_MAX_SENSORS; ++i) {
+		if(!(m_state->sensorsSet & (1 << i))) {continue;}
+		message.addString(shared::SensorName((SDL_SensorType)i));
+		message.addFloat(m_state->sensors[i][0]);
+		message.addFloat(m_state->sensors[i][1]);
+		message.addFloat(m_state->sensors[i][2]);
+	}
+}
+
+const char* Device::buildInputPath(EventType type, const char *name, int id) {
+	return internString(std::string(m_sendPaths[type]) + "/" + (name ? name : std::to_string(id)));
+}
+
+void Device::setSensorState(SDL_SensorType type, float x, float y, float z) {
+	uint8_t bit = DeviceState::sensorBit(type);
+	if(bit) {
+		float *state = m_state->sensors[(int)type];
+		state[0] = x;
+		state[1] = y;
+		state[2] = z;
+		m_state->sensorsSet |= bit;
+	}
+	if(!m_sharedState) {return;}
+	StateTable::beginWrite(m_sharedState);
+	for(uint32_t i = 0; i < JOYOSC_STATE_MAX_SENSORS; ++i) {
+		joyosc_state_sensor &sensor = m_sharedState->sensors[i];
+		if(i == m_sharedState->num_sensors) { // new sensor, take next
+			sensor.type = (int32_t)type;
+			m_sharedState->num_sensors++;
+		}
+		if(sensor.type == (int32_t)type) {
+			sensor.values[0] = x;
+			sensor.values[1] = y;
+			sensor.values[2] = z;
+			break;
+		}
+	}
+	StateTable::endWrite(m_sharedState);
+}
+
+void Device::setStateSize(int numAxes, int numHats) {
+	m_state->numAxes = (uint8_t)CLAMP(numAxes, 0, DEVICE_STATE_MAX_AXES);
+	m_state->numHats = (uint8_t)CLAMP(numHats, 0, DEVICE_STATE_MAX_HATS);
+}
+
+void Device::publishState() {
+	if(!stateTable || m_sharedState) {return;}
+	uint32_t type = JOYOSC_STATE_UNUSED;
+	switch(getType()) {
+		case JOYSTICK:       type = JOYOSC_STATE_JOYSTICK; break;
+		case GAMECONTROLLER: type = JOYOSC_STATE_GAMECONTROLLER; break;
+		default: return;
+	}
+	m_sharedState = stateTable->add(type, m_index.index, m_address, m_name,
+	                                m_state->numAxes, m_state->numHats);
+	if(!m_sharedState) {
+		LOG_WARN << toString() << ": state table full, not publishing state" << std::endl;
+		return;
+	}
+	StateTable::beginWrite(m_sharedState);
+	m_sharedState->buttons = m_state->buttons;
+	for(size_t i = 0; i < m_sharedState->num_hats; ++i) {
+		m_sharedState->hats[i] = m_state->hats[i];
+	}
+	StateTable::endWrite(m_sharedState);
+}
+
+void Device::unpublishState() {
+	if(!m_sharedState) {return;}
+	stateTable->remove(m_sharedState);
+	m_sharedState = nullptr;
+}
+
 std::string Device::toString() {
 	std::stringstream s;
 	s << m_index.index << " " << m_name << " " << m_address;
@@ -70,3 +195,33 @@ std::string Device::toString() {
 std::string Device::GUIDForSDLIndex(int sdlIndex) {
 	return shared::JoystickGUIDForIndex(sdlIndex);
 }
+
+const char* Device::eventTypeName(EventType type) {
+	switch(type) {
+		case BUTTON:   return "button";
+		case AXIS:     return "axis";
+		case BALL:     return "ball";
+		case HAT:      return "hat";
+		case TOUCHPAD: return "touchpad";
+		case SENSOR:   return "sensor";
+		default:       return "unknown";
+	}
+}
+
+std::string Device::addressWithIndex(const std::string &address, int index) {
+	std::string ret = address;
+	std::string number = std::to_string(index);
+	for(size_t pos = ret.find('#'); pos != std::string::npos; pos = ret.find('#', pos)) {
+		ret.replace(pos, 1, number);
+		pos += number.size();
+	}
+	return ret;
+}
+
+// set nodes are never moved, so c_str() pointers stay valid
+const char* Device::internString(const std::string &s) {
+	static std::set<std::string> strings;
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+	return strings.insert(s).first->c_str();
+}
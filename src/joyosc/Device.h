@@ -24,6 +24,8 @@
 
 #include "Common.h"
 #include "Event.h"
+#include "Sender.h"
+#include "StateTable.h"
 
 /// \class DeviceIndex
 /// \brief index struct for opening a game controller or joystick
@@ -59,11 +61,82 @@ struct DeviceSettings {
 	std::string address = ""; ///< OSC address
 	unsigned int axisDeadZone = 0; ///< zeroing threshold
 	bool normalizeAxes = false; ///< normalize axis values?
+	int inputAddresses = -1; ///< send each input on its own address? -1 for the shared default
 	EventRemapping* remap = nullptr; ///< event remappings
 	EventIgnore *ignore = nullptr; ///< event ignore rules
 	void *data = nullptr; ///< device type specific data
 };
 
+/// max number of axes in the device state, others are sent without
+/// repeat filtering & are not in state snapshots
+#define DEVICE_STATE_MAX_AXES 32
+
+/// max number of hats in the device state, others are not in state snapshots
+#define DEVICE_STATE_MAX_HATS 8
+
+/// max number of sensor types in the device state, by SDL_SensorType value
+#define DEVICE_STATE_MAX_SENSORS 8
+
+/// \struct DeviceState
+/// \brief per-event device state & current input state for state snapshots
+///
+/// Everything read or written while handling an event is packed into one
+/// block of whole cache lines so the working set stays small with many
+/// devices. Names, paths, & other cold data stay in the Device. The
+/// DeviceManager owns the blocks, see DeviceManager::stateBlock().
+struct DeviceState {
+
+	// axes
+	int16_t axes[DEVICE_STATE_MAX_AXES] = {0}; ///< raw axis values -32768 - 32767
+	int16_t prevAxisValues[DEVICE_STATE_MAX_AXES] = {0}; ///< prev sent axis values to cancel repeats
+
+	// buttons, hats, & settings
+	uint64_t buttons = 0; ///< button bitmask, bit n = button n, max 64 buttons
+	uint32_t sequence = 0; ///< sequence number of the last event sent
+	int32_t axisDeadZone = 3200; ///< axis dead zone amount +/- center pos
+	uint32_t sensorRateMS = 0; ///< sensor rate limit in ms between frames, 0 for unlimited
+	uint8_t numAxes = 0; ///< number of axes in state snapshots
+	uint8_t numHats = 0; ///< number of hats in state snapshots
+	uint8_t sensorsLimited = 0; ///< rate limited sensor bits by sensor type
+	uint8_t sensorsSet = 0; ///< set sensor value bits by sensor type
+	uint8_t sensorClocksSet = 0; ///< set sensor clock offset bits by sensor type
+	uint8_t hats[DEVICE_STATE_MAX_HATS] = {0}; ///< hat values
+	uint32_t sensorTimes[DEVICE_STATE_MAX_SENSORS] = {0}; ///< prev sent sensor timestamps for rate limit
+
+	// sensors
+	float sensors[DEVICE_STATE_MAX_SENSORS][3] = {}; ///< latest sensor x, y, & z
+	int64_t sensorClockOffsets[DEVICE_STATE_MAX_SENSORS] = {0}; ///< sensor clock to SDL event time offsets in us
+	char pad[24]; ///< pad to whole cache lines
+
+	/// clear input values, keeps settings & the sequence number
+	void clearInputs() {
+		DeviceState state;
+		state.sequence = sequence;
+		state.axisDeadZone = axisDeadZone;
+		state.sensorRateMS = sensorRateMS;
+		*this = state;
+	}
+
+	/// returns the sensor type bit or 0 if the type is not kept
+	inline static uint8_t sensorBit(SDL_SensorType type) {
+		return ((int)type >= 0 && (int)type < DEVICE_STATE_MAX_SENSORS ? 1 << (int)type : 0);
+	}
+};
+
+static_assert(sizeof(DeviceState) % 64 == 0, "DeviceState must fill whole cache lines");
+
+/// compiled remapping & ignore rule for a single input, see compileInputs()
+struct InputRule {
+	bool ignored = false; ///< ignore the input?
+	int id = -1; ///< remapped id, numeric id for named inputs, -1 if none
+	const char *name = nullptr; ///< interned remapped name, if named
+	const char *path = nullptr; ///< interned per-input send path, see addInputPaths()
+	const char *triggerName = nullptr; ///< interned remapped trigger button name, if a trigger
+	int triggerId = -1; ///< trigger button numeric id, -1 if none
+	bool triggerIgnored = false; ///< ignore the trigger when sent as a button?
+	const char *triggerPath = nullptr; ///< interned trigger button send path, if a trigger
+};
+
 /// \class Device
 /// \brief a baseclass for an event-based input device
 class Device {
@@ -78,6 +151,11 @@ class Device {
 		/// returns true on success
 		virtual bool open(DeviceIndex index, DeviceSettings *settings=nullptr) = 0;
 
+		/// finish opening the device, ie. slower haptic, sensor, & LED setup,
+		/// events are handled before this so it can be deferred while other
+		/// devices keep running, call after open()
+		virtual void finishOpen() {}
+
 		/// close the device
 		virtual void close() = 0;
 
@@ -112,11 +190,19 @@ class Device {
 		inline std::string getName() {return m_name;}
 
 		/// set the OSC address of this device ie. "/js0" etc
-		inline void setAddress(std::string address) {m_address = address;}
+		void setAddress(const std::string &address);
 
 		/// get the OSC address of this device ie. "/js0" etc
 		inline std::string getAddress() {return m_address;}
 
+		/// get the full OSC send path for an event type,
+		/// ie. "/joyosc/devices/js0/button", stays valid for the program lifetime
+		inline const char* getSendPath(EventType type) {return m_sendPaths[type];}
+
+		/// rebuild send paths from the device address & current base address,
+		/// call after deviceAddress changes
+		void updateSendPaths();
+
 		/// get index in the devices list
 		inline int getIndex() {return m_index.index;}
 
@@ -130,14 +216,24 @@ class Device {
 		void setAxisDeadZone(unsigned int zone);
 
 		/// get axis dead zone
-		inline int getAxisDeadZone() {return m_axisDeadZone;}
+		inline int getAxisDeadZone() {return m_state->axisDeadZone;}
 
 		/// enable/disable axis value normalization
-		void setNormalizeAxes(bool enable) {m_normalizeAxes = enable;}
+		void setNormalizeAxes(bool enable) {
+			m_normalizeAxes = enable;
+			selectHandler();
+		}
 
 		/// get normalize axes
 		inline bool getNormalizeAxes() {return m_normalizeAxes;}
 
+		/// enable/disable sending each input on its own address,
+		/// ie. ".../button/a 1" instead of ".../button a 1"
+		void setInputAddresses(bool enable) {m_inputAddresses = enable;}
+
+		/// get input addresses
+		inline bool getInputAddresses() {return m_inputAddresses;}
+
 		/// set button, axis, etc remappings
 		void setRemapping(EventRemapping *remapping);
 
@@ -156,6 +252,30 @@ class Device {
 		/// print button, axis, etc ignores
 		void printIgnores();
 
+		/// get current input state
+		inline const DeviceState& getState() {return *m_state;}
+
+		/// set the per-event state block, copies the current state into it,
+		/// call before open()
+		/// note: the block is owned by the caller, ie. the DeviceManager, &
+		///       must stay valid while the device exists
+		void setStateBlock(DeviceState *block);
+
+		/// get the per-event state block
+		inline DeviceState* getStateBlock() {return m_state;}
+
+		/// send current input state as a single OSC message:
+		/// "/state" h buttons f axes... i hats... [s sensor f x f y f z]...
+		void sendState();
+
+		/// send current input state as a keyframe OSC message with the
+		/// sequence number of the last event sent:
+		/// "/keyframe" i sequence h buttons f axes... i hats... [s sensor f x f y f z]...
+		void sendKeyframe();
+
+		/// get the sequence number of the last event sent, 0 if none
+		inline uint32_t getSequence() {return m_state->sequence;}
+
 		/// returns basic device info as a string
 		virtual std::string toString();
 
@@ -173,19 +293,40 @@ class Device {
 		/// return GUID for device at sdlIndex or "" on failure
 		static std::string GUIDForSDLIndex(int sdlIndex);
 
+		/// returns the send path component for an event type, ie. "button"
+		static const char* eventTypeName(EventType type);
+
+		/// returns address with each # replaced by index, ie. "/gc#" -> "/gc1"
+		static std::string addressWithIndex(const std::string &address, int index);
+
+		/// returns a pointer to a shared copy of a string which stays valid
+		/// for the lifetime of the program, thread safe
+		static const char* internString(const std::string &s);
+
 	/// \section shared settings
 
 		/// base OSC sending addess for devices
+		/// note: call updateSendPaths() on open devices after changing
 		static std::string deviceAddress;
 
 		/// base OSC receiving address for devices
 		static const std::string receiveAddress;
 
 		/// print lots of events?
+		/// note: devices read this when selecting their event handler on open
 		static bool printEvents;
 
+		/// send event messages? otherwise only state is updated
+		static bool streamEvents;
+
+		/// add a per-device sequence number to event messages for keyframe sync?
+		static bool sync;
+
 		/// shared OSC sender, required!
-		static lo::Address *sender;
+		static Sender *sender;
+
+		/// shared memory state table, nullptr if not publishing
+		static StateTable *stateTable;
 
 	/// \section shared defaults
 
@@ -193,18 +334,132 @@ class Device {
 		/// note: this is the shared default, may be overriden per-instance
 		static bool normalizeAxes;
 
+		/// send each input on its own address
+		/// note: this is the shared default, may be overriden per-instance
+		static bool inputAddresses;
+
 	protected:
 
+		/// send event record, if streaming events, inputPath is the prebuilt
+		/// per-input send path used when sending input addresses, if any
+		inline void sendRecord(EventRecord &record, const char *inputPath) {
+			if(streamEvents) {
+				record.address = m_sendAddress;
+				record.device = m_index.index;
+				if(m_inputAddresses && inputPath) {
+					record.path = inputPath;
+					record.inputPath = true;
+				}
+				if(sync) {
+					// 0 means no sequence number, skip it on wraparound
+					if(++m_state->sequence == 0) {m_state->sequence = 1;}
+					record.sequence = m_state->sequence;
+				}
+				sender->send(record);
+			}
+		}
+
+		/// set button state bit, ignores buttons > 63
+		inline void setButtonState(int button, bool pressed) {
+			if(button < 0 || button > 63) {return;}
+			if(pressed) {m_state->buttons |= ((uint64_t)1 << button);}
+			else {m_state->buttons &= ~((uint64_t)1 << button);}
+			if(m_sharedState) {
+				StateTable::beginWrite(m_sharedState);
+				m_sharedState->buttons = m_state->buttons;
+				StateTable::endWrite(m_sharedState);
+			}
+		}
+
+		/// set raw axis state value -32768 - 32767, ignores unknown axes
+		inline void setAxisState(int axis, int value) {
+			if(axis < 0 || axis >= m_state->numAxes) {return;}
+			m_state->axes[axis] = (int16_t)value;
+			if(m_sharedState && axis < JOYOSC_STATE_MAX_AXES) {
+				StateTable::beginWrite(m_sharedState);
+				m_sharedState->axes[axis] = (int16_t)value;
+				StateTable::endWrite(m_sharedState);
+			}
+		}
+
+		/// set hat state value, ignores unknown hats
+		inline void setHatState(int hat, int value) {
+			if(hat < 0 || hat >= m_state->numHats) {return;}
+			m_state->hats[hat] = (uint8_t)value;
+			if(m_sharedState && hat < JOYOSC_STATE_MAX_HATS) {
+				StateTable::beginWrite(m_sharedState);
+				m_sharedState->hats[hat] = (uint8_t)value;
+				StateTable::endWrite(m_sharedState);
+			}
+		}
+
+		/// returns the interned per-input send path for an input name or id if
+		/// name is nullptr, ie. "/joyosc/devices/gc0/button/a"
+		const char* buildInputPath(EventType type, const char *name, int id);
+
+		/// build the per-input send paths for all known inputs into the
+		/// compiled rules so sending only loads a pointer, call in open()
+		/// after compileInputs(), also called when the send paths change
+		virtual void addInputPaths() {}
+
+		/// compile the remapping & ignore rules into per-input tables indexed
+		/// by SDL input id so handling an event needs no lookups, call in
+		/// open() after setting the remapping & ignore
+		virtual void compileInputs() {}
+
+		/// select the event handler instantiation for the current flags, ie.
+		/// normalize axes & print events, so flags are not tested per event,
+		/// call in open() & when a flag changes
+		virtual void selectHandler() {}
+
+		/// returns true if the axis value was already sent & stores it if not,
+		/// axes beyond the state are never repeats
+		inline bool isAxisRepeat(int axis, int value) {
+			if(axis < 0 || axis >= DEVICE_STATE_MAX_AXES) {return false;}
+			if(m_state->prevAxisValues[axis] == value) {return true;}
+			m_state->prevAxisValues[axis] = (int16_t)value;
+			return false;
+		}
+
+		/// set the number of axes & hats in the state, clamped to the max
+		void setStateSize(int numAxes, int numHats);
+
+		/// returns the compiled rule for an SDL input id or nullptr if unknown
+		inline const InputRule* inputRule(EventType type, int id) {
+			return ((size_t)id < m_inputRules[type].size() ? &m_inputRules[type][id] : nullptr);
+		}
+
+		/// set latest sensor state values
+		void setSensorState(SDL_SensorType type, float x, float y, float z);
+
+		/// add current input state arguments to a state or keyframe message
+		void addState(OscMessage &message);
+
+		/// take a state table slot & write the current state, if publishing,
+		/// call at the end of open()
+		void publishState();
+
+		/// free the state table slot, if any, call in close()
+		void unpublishState();
+
 		std::string	m_name = ""; ///< device name ie. "PS3 Controller"
 		std::string	m_address = ""; ///< OSC address of this device ie. "/js0" etc
+		const char *m_sendPaths[EVENT_TYPE_COUNT]; ///< interned send paths by event type
+		const char *m_statePath = ""; ///< interned state send path
+		const char *m_keyframePath = ""; ///< interned keyframe send path
+		const char *m_sendAddress = ""; ///< interned address for send filters
 
 		DeviceIndex m_index; ///< device list index & SDL index
 		SDL_JoystickID m_instanceID = -1; ///< unique SDL instance ID, *not* SDL index
 
-		unsigned int m_axisDeadZone = 3200; ///< axis dead zone amount +/- center pos
-		std::vector<int16_t> m_prevAxisValues; ///< prev axis values to cancel repeats
 		bool m_normalizeAxes = false; ///< normalize axis values?
+		bool m_inputAddresses = false; ///< send each input on its own address?
+
+		DeviceState *m_state = &m_ownState; ///< per-event & current input state block
+		DeviceState m_ownState; ///< own state block, if none is set
+		joyosc_state_device *m_sharedState = nullptr; ///< state table slot, if any
 
 		EventRemapping *m_remapping = nullptr; ///< button, axis, etc remappings
 		EventIgnore *m_ignore = nullptr; ///< button, axis, etc ignores
+		std::vector<InputRule> m_inputRules[EVENT_TYPE_COUNT]; ///< compiled rules by SDL input id
 };
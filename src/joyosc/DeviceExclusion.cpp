@@ -78,7 +78,10 @@ bool DeviceExclusion::readXML(XMLElement *e) {
 }
 
 bool DeviceExclusion::isExcluded(DeviceType type, int sdlIndex) {
-	std::string guid = Device::GUIDForSDLIndex(sdlIndex);
+	return isExcluded(type, sdlIndex, Device::GUIDForSDLIndex(sdlIndex));
+}
+
+bool DeviceExclusion::isExcluded(DeviceType type, int sdlIndex, const std::string &guid) {
 	if(guid != "" && guids.find(guid) != guids.end()) {
 		return true;
 	}
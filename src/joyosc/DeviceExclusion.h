@@ -38,6 +38,9 @@ class DeviceExclusion {
 		/// check device exclude status
 		bool isExcluded(DeviceType type, int sdlIndex);
 
+		/// check device exclude status with an already formatted GUID string
+		bool isExcluded(DeviceType type, int sdlIndex, const std::string &guid);
+
 		/// print current exclude values
 		void print();
 
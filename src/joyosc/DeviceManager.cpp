@@ -51,22 +51,25 @@ bool DeviceManager::readXML(XMLElement *e) {
 void DeviceManager::subscribe(lo::ServerThread *receiver) {
 	m_receiver = receiver;
 	m_receiver->add_method("/" PACKAGE "/query/count", "", [this]() {
-		Device::sender->send(DeviceManager::queryAddress + "/count",
+		Device::sender->sendReply(DeviceManager::queryAddress + "/count",
 			                 "i", (int)m_devices.size());
 		return 0; // handled
 	});
-	m_receiver->add_method("/" PACKAGE "/query", "", [this]() {
-		for(auto &iter : m_devices) {sendDeviceInfo(iter.second);}
+	m_receiver->add_method("/" PACKAGE "/query/schema", "", [this]() {
+		GameController::sendSchema(DeviceManager::queryAddress + "/schema");
 		return 0; // handled
 	});
-	m_receiver->add_method("/" PACKAGE "/query", "i", [this](lo_arg** argv, int argc) {
-		int index = argv[0]->i;
-		if(index > -1 && index < (int)m_devices.size()) {
-			Device *device = get(index);
+	m_receiver->add_method("/" PACKAGE "/query", "", [this]() {
+		for(Device *device : m_indices) { // in index order
 			if(device) {sendDeviceInfo(device);}
 		}
 		return 0; // handled
 	});
+	m_receiver->add_method("/" PACKAGE "/query", "i", [this](lo_arg** argv, int argc) {
+		Device *device = get(argv[0]->i);
+		if(device) {sendDeviceInfo(device);}
+		return 0; // handled
+	});
 	m_receiver->add_method("/" PACKAGE "/query", "s", [this](lo_arg** argv, int argc) {
 		Device *device = get("/" + std::string(&argv[0]->s));
 		if(device) {sendDeviceInfo(device);}
@@ -76,103 +79,55 @@ void DeviceManager::subscribe(lo::ServerThread *receiver) {
 
 void DeviceManager::unsubscribe(lo::ServerThread *receiver) {
 	m_receiver->del_method("/" PACKAGE "/query/count", "");
+	m_receiver->del_method("/" PACKAGE "/query/schema", "");
 	m_receiver->del_method("/" PACKAGE "/query", "");
 	m_receiver->del_method("/" PACKAGE "/query", "i");
 	m_receiver->del_method("/" PACKAGE "/query", "s");
 }
 
-// try finding matching device GUID, otherwise name
 bool DeviceManager::open(int sdlIndex) {
-	if(sdlIndexExists(sdlIndex)) {
-		return false; // ignore duplicates
-	}
-	DeviceIndex index;
-	index.index = firstAvailableIndex();
-	index.sdlIndex = sdlIndex;
-	if(SDL_IsGameController(sdlIndex) == SDL_TRUE && !joysticksOnly) {
-		if(!m_deviceExclusion.isExcluded(GAMECONTROLLER, sdlIndex)) {
-			DeviceSettings *settings = nullptr;
-			std::string guid = Device::GUIDForSDLIndex(sdlIndex);
-			if(guid != "") {
-				settings = m_deviceSettings.settingsFor(GAMECONTROLLER, guid);
-			}
-			if(!settings) {
-				const char *name = SDL_GameControllerNameForIndex(sdlIndex);
-				if(name) {
-					settings = m_deviceSettings.settingsFor(GAMECONTROLLER, name);
-				}
-			}
-			std::string address = addressForIndex(GAMECONTROLLER, index.index);
-			GameController *controller = new GameController(address);
-			if(controller->open(index, settings)) {
-				m_devices[controller->getInstanceID()] = controller;
-				m_addresses[controller->getAddress()] = controller;
-				controller->subscribe(m_receiver);
-				if(sendDeviceEvents) {
-					std::string address = controller->getAddress().substr(1); // drop leading /
-					Device::sender->send(DeviceManager::notificationAddress + "/open",
-						"sis", "controller", index.index, address.c_str());
-				}
-				return true;
-			}
-			if(controller) {delete controller;}
-		}
-	}
-	else {
-		if(!m_deviceExclusion.isExcluded(JOYSTICK, sdlIndex)) {
-			DeviceSettings *settings = nullptr;
-			std::string guid = Device::GUIDForSDLIndex(sdlIndex);
-			if(guid != "") {
-				settings = m_deviceSettings.settingsFor(JOYSTICK, guid);
-			}
-			if(!settings) {
-				const char *name = SDL_JoystickNameForIndex(sdlIndex);
-				if(name) {
-					settings = m_deviceSettings.settingsFor(JOYSTICK, name);
-				}
-			}
-			std::string address = addressForIndex(JOYSTICK, index.index);
-			Joystick *joystick = new Joystick(address);
-			if(joystick->open(index, settings)) {
-				m_devices[joystick->getInstanceID()] = joystick;
-				m_addresses[joystick->getAddress()] = joystick;
-				joystick->subscribe(m_receiver);
-				if(sendDeviceEvents) {
-					std::string address = joystick->getAddress().substr(1); // drop leading /
-					Device::sender->send(DeviceManager::notificationAddress + "/open",
-						"sis", "joystick", index.index, address.c_str());
-				}
-				return true;
-			}
-			if(joystick) {delete joystick;}
-		}
+	Uint64 start = SDL_GetPerformanceCounter();
+	Device *device = openDevice(sdlIndex);
+	if(!device) {
+		return false;
 	}
-	return false;
+	device->finishOpen();
+	Uint64 duration = SDL_GetPerformanceCounter() - start;
+	printOpenTime(device, duration, duration);
+	return true;
 }
 
 bool DeviceManager::close(SDL_JoystickID instanceID) {
-	if(m_devices.find(instanceID) != m_devices.end()) {
-		Device *device = m_devices[instanceID];
+	if(m_pendingIDs.erase(instanceID)) {
+		for(auto iter = m_pending.begin(); iter != m_pending.end(); ++iter) {
+			if(iter->instanceID == instanceID) {
+				m_pending.erase(iter); // removed while opening
+				break;
+			}
+		}
+	}
+	Device *device = find(instanceID);
+	if(device) {
 		if(sendDeviceEvents) {
 			std::string address = device->getAddress().substr(1); // drop leading /
 			switch(device->getType()) {
 				case GAMECONTROLLER:
-					Device::sender->send(DeviceManager::notificationAddress + "/close",
+					Device::sender->sendNotification(DeviceManager::notificationAddress + "/close",
 						"sis", "controller", ((GameController *)device)->getIndex(),
 						address.c_str());
 					break;
 				default: // JOYSTICK, should never be UNKNOWN
-					Device::sender->send(DeviceManager::notificationAddress + "/close",
+					Device::sender->sendNotification(DeviceManager::notificationAddress + "/close",
 						"sis", "joystick", ((Joystick *)device)->getIndex(),
 						address.c_str());
 					break;
 			}
 		}
-		m_addresses.erase(device->getAddress());
+		unregisterDevice(device);
 		device->unsubscribe(m_receiver);
 		device->close();
+		releaseStateBlock(device->getStateBlock());
 		delete device;
-		m_devices.erase(instanceID);
 		return true;
 	}
 	return false;
@@ -184,13 +139,45 @@ void DeviceManager::openAll() {
 	}
 }
 
+// one step per call so opening is spread over several loop iterations, a
+// device is opened & handles events first, then finishes opening
+void DeviceManager::openPending() {
+	if(m_pending.empty()) {
+		return;
+	}
+	PendingOpen &pending = m_pending.front();
+	Uint64 start = SDL_GetPerformanceCounter();
+	if(!pending.device) {
+		int sdlIndex = sdlIndexFor(pending);
+		pending.device = (sdlIndex > -1 ? openDevice(sdlIndex) : nullptr);
+		pending.work += SDL_GetPerformanceCounter() - start;
+		if(pending.device) {
+			return; // finish next time
+		}
+	}
+	else {
+		pending.device->finishOpen();
+		pending.work += SDL_GetPerformanceCounter() - start;
+		printOpenTime(pending.device, SDL_GetPerformanceCounter() - pending.added, pending.work);
+		if(Log::logLevel == Log::LEVEL_DEBUG) {print();}
+	}
+	m_pendingIDs.erase(pending.instanceID);
+	m_pending.pop_front();
+}
+
 void DeviceManager::closeAll() {
-	for(auto &iter : m_devices) {
-		Device *device = iter.second;
+	m_pending.clear();
+	m_pendingIDs.clear();
+	for(Device *device : m_indices) {
+		if(!device) {continue;}
 		device->close();
+		releaseStateBlock(device->getStateBlock());
 		delete device;
 	}
-	m_devices.clear();	
+	m_devices.clear();
+	m_indices.clear();
+	m_freeIndices = decltype(m_freeIndices)();
+	m_addresses.clear();
 }
 
 // controller hotplugging: https://gist.github.com/urkle/6701236
@@ -199,9 +186,7 @@ bool DeviceManager::handleEvent(SDL_Event *event) {
 
 		case SDL_CONTROLLERDEVICEADDED:
 			LOG_DEBUG << "CONTROLLER ADDED instanceID " << event->cdevice.which << std::endl;
-			if(open(event->cdevice.which)) {
-				if(Log::logLevel == Log::LEVEL_DEBUG) {print();}
-			}
+			queueOpen(event->cdevice.which);
 			return true;
 
 		case SDL_CONTROLLERDEVICEREMAPPED:
@@ -211,11 +196,13 @@ bool DeviceManager::handleEvent(SDL_Event *event) {
 		case SDL_CONTROLLERBUTTONDOWN: case SDL_CONTROLLERBUTTONUP:
 		case SDL_CONTROLLERAXISMOTION: case SDL_CONTROLLERTOUCHPADDOWN:
 		case SDL_CONTROLLERTOUCHPADMOTION: case SDL_CONTROLLERTOUCHPADUP:
-		case SDL_CONTROLLERSENSORUPDATE:
-			if(getDeviceType(event->cdevice.which) == GAMECONTROLLER) {
-				return m_devices[event->cdevice.which]->handleEvent(event);
+		case SDL_CONTROLLERSENSORUPDATE: {
+			Device *device = find(event->cdevice.which);
+			if(device && device->getType() == GAMECONTROLLER) {
+				return device->handleEvent(event);
 			}
 			return false;
+		}
 
 		case SDL_CONTROLLERDEVICEREMOVED:
 			LOG_DEBUG << "CONTROLLER REMOVED instanceID " << event->cdevice.which << std::endl;
@@ -226,16 +213,14 @@ bool DeviceManager::handleEvent(SDL_Event *event) {
 
 		case SDL_JOYDEVICEADDED:
 			LOG_DEBUG << "JOYSTICK ADDED instanceID " << event->jdevice.which << std::endl;
-			if(open(event->jdevice.which)) {
-				if(Log::logLevel == Log::LEVEL_DEBUG) {print();}
-			}
+			queueOpen(event->jdevice.which);
 			return true;
 
 		case SDL_JOYBUTTONDOWN: case SDL_JOYBUTTONUP:
 		case SDL_JOYAXISMOTION: {
-			DeviceType type = getDeviceType(event->jdevice.which);
-			if(type != UNKNOWN) {
-				Device *device = m_devices[event->jdevice.which];
+			Device *device = find(event->jdevice.which);
+			if(device) {
+				DeviceType type = device->getType();
 				if(type == JOYSTICK || (type == GAMECONTROLLER &&
 					((GameController *)device)->hasExtendedMappings())) {
 					device->handleEvent(event);
@@ -244,11 +229,13 @@ bool DeviceManager::handleEvent(SDL_Event *event) {
 			return false;
 		}
 
-		case SDL_JOYBALLMOTION: case SDL_JOYHATMOTION:
-			if(getDeviceType(event->jdevice.which) == JOYSTICK) {
-				return m_devices[event->jdevice.which]->handleEvent(event);
+		case SDL_JOYBALLMOTION: case SDL_JOYHATMOTION: {
+			Device *device = find(event->jdevice.which);
+			if(device && device->getType() == JOYSTICK) {
+				return device->handleEvent(event);
 			}
 			return false;
+		}
 
 		case SDL_JOYDEVICEREMOVED:
 			LOG_DEBUG << "JOYSTICK REMOVED instanceID " << event->jdevice.which << std::endl;
@@ -270,15 +257,6 @@ Device* DeviceManager::get(const std::string &address) {
 	return nullptr;
 }
 
-Device* DeviceManager::get(int index) {
-	for(auto &iter : m_devices) {
-		if(iter.second->getIndex() == index) {
-			return iter.second;
-		}
-	}
-	return nullptr;
-}
-
 void DeviceManager::sendDeviceInfo(Device *device) {
 	switch(device->getType()) {
 		case GAMECONTROLLER: {
@@ -291,7 +269,7 @@ void DeviceManager::sendDeviceInfo(Device *device) {
 			int rumble = (int)SDL_GameControllerHasRumble(controller);
 			int led = (int)SDL_GameControllerHasLED(controller);
 			std::string address = device->getAddress().substr(1); // drop leading /
-			Device::sender->send(
+			Device::sender->sendReply(
 				DeviceManager::queryAddress + "/device",
 				"sisiiiiii", "controller", device->getIndex(), address.c_str(),
 				buttons, axes, touchpads, sensors, rumble, led
@@ -306,7 +284,7 @@ void DeviceManager::sendDeviceInfo(Device *device) {
 			int hats = SDL_JoystickNumHats(joystick);
 			int rumble = (int)SDL_JoystickIsHaptic(joystick);
 			std::string address = device->getAddress().substr(1); // drop leading /
-			Device::sender->send(
+			Device::sender->sendReply(
 				DeviceManager::queryAddress + "/device",
 				"sisiiiii", "joystick", device->getIndex(), address.c_str(),
 				buttons, axes, balls, hats, rumble
@@ -318,18 +296,64 @@ void DeviceManager::sendDeviceInfo(Device *device) {
 	}
 }
 
+void DeviceManager::sendStates() {
+	for(Device *device : m_indices) {
+		if(device) {device->sendState();}
+	}
+}
+
+void DeviceManager::sendKeyframes() {
+	for(Device *device : m_indices) {
+		if(device) {device->sendKeyframe();}
+	}
+}
+
+void DeviceManager::requestKeyframe(const std::string &address) {
+	std::lock_guard<std::mutex> lock(m_keyframeMutex);
+	m_keyframeRequests.push_back(address);
+	m_keyframesRequested = true;
+}
+
+// requests come from the receiver thread, keyframes are sent from the event
+// loop so the state & sequence numbers are consistent
+void DeviceManager::sendRequestedKeyframes() {
+	if(!m_keyframesRequested) {return;}
+	{
+		std::lock_guard<std::mutex> lock(m_keyframeMutex);
+		m_keyframesToSend.swap(m_keyframeRequests);
+		m_keyframesRequested = false;
+	}
+	for(auto &address : m_keyframesToSend) {
+		if(address == "") {
+			sendKeyframes();
+			break; // all devices, the rest are included
+		}
+		Device *device = get(address);
+		if(device) {device->sendKeyframe();}
+	}
+	m_keyframesToSend.clear();
+}
+
+void DeviceManager::setDeviceAddress(const std::string &address) {
+	Device::deviceAddress = address;
+	for(Device *device : m_indices) {
+		if(device) {device->updateSendPaths();}
+	}
+}
+
 void DeviceManager::printKnownDevices() {
 	LOG << "known devices: " << m_deviceSettings.size() << std::endl;
 	m_deviceSettings.print();
 }
 
 void DeviceManager::print(bool details) {
-	for(auto &iter : m_devices) {
+	for(Device *device : m_indices) {
+		if(!device) {continue;}
 		if(details) {
-			iter.second->print();
+			device->print();
 		}
 		else {
-			LOG << iter.second->toString() << std::endl;
+			LOG << device->toString() << std::endl;
 		}
 	}
 }
@@ -347,37 +371,190 @@ std::string DeviceManager::addressForIndex(DeviceType type, int index) {
 	return stream.str();
 }
 
-// brute force search for first available index, works with fact
-// that the map is ordered
-int DeviceManager::firstAvailableIndex() {
-	for(unsigned int i = 0; i < m_devices.size(); ++i) {
-		if(m_devices.find(i) == m_devices.end()) {
-			return i;
+// try finding matching device GUID, otherwise name
+Device* DeviceManager::openDevice(int sdlIndex) {
+	if(sdlIndexExists(sdlIndex)) {
+		return nullptr; // ignore duplicates
+	}
+	std::string guid = Device::GUIDForSDLIndex(sdlIndex);
+	DeviceIndex index;
+	index.index = takeIndex();
+	index.sdlIndex = sdlIndex;
+	if(SDL_IsGameController(sdlIndex) == SDL_TRUE && !joysticksOnly) {
+		if(!m_deviceExclusion.isExcluded(GAMECONTROLLER, sdlIndex, guid)) {
+			DeviceSettings *settings = nullptr;
+			if(guid != "") {
+				settings = m_deviceSettings.settingsFor(GAMECONTROLLER, guid);
+			}
+			if(!settings) {
+				const char *name = SDL_GameControllerNameForIndex(sdlIndex);
+				if(name) {
+					settings = m_deviceSettings.settingsFor(GAMECONTROLLER, name);
+				}
+			}
+			std::string address = addressForIndex(GAMECONTROLLER, index.index);
+			GameController *controller = new GameController(address);
+			controller->setStateBlock(takeStateBlock());
+			if(controller->open(index, settings)) {
+				registerDevice(controller);
+				controller->subscribe(m_receiver);
+				if(sendDeviceEvents) {
+					std::string address = controller->getAddress().substr(1); // drop leading /
+					Device::sender->sendNotification(DeviceManager::notificationAddress + "/open",
+						"sis", "controller", index.index, address.c_str());
+				}
+				if(Device::sync) {
+					// initial state for consumers to sync to
+					controller->sendKeyframe();
+				}
+				return controller;
+			}
+			if(controller) {
+				releaseStateBlock(controller->getStateBlock());
+				delete controller;
+			}
 		}
 	}
-	return m_devices.size();
+	else {
+		if(!m_deviceExclusion.isExcluded(JOYSTICK, sdlIndex, guid)) {
+			DeviceSettings *settings = nullptr;
+			if(guid != "") {
+				settings = m_deviceSettings.settingsFor(JOYSTICK, guid);
+			}
+			if(!settings) {
+				const char *name = SDL_JoystickNameForIndex(sdlIndex);
+				if(name) {
+					settings = m_deviceSettings.settingsFor(JOYSTICK, name);
+				}
+			}
+			std::string address = addressForIndex(JOYSTICK, index.index);
+			Joystick *joystick = new Joystick(address);
+			joystick->setStateBlock(takeStateBlock());
+			if(joystick->open(index, settings)) {
+				registerDevice(joystick);
+				joystick->subscribe(m_receiver);
+				if(sendDeviceEvents) {
+					std::string address = joystick->getAddress().substr(1); // drop leading /
+					Device::sender->sendNotification(DeviceManager::notificationAddress + "/open",
+						"sis", "joystick", index.index, address.c_str());
+				}
+				if(Device::sync) {
+					// initial state for consumers to sync to
+					joystick->sendKeyframe();
+				}
+				return joystick;
+			}
+			if(joystick) {
+				releaseStateBlock(joystick->getStateBlock());
+				delete joystick;
+			}
+		}
+	}
+	releaseIndex(index.index);
+	return nullptr;
 }
 
-bool DeviceManager::sdlIndexExists(int sdlIndex) {
-	for(auto &iter : m_devices) {
-		if(iter.second->getType() == GAMECONTROLLER) {
-			if(((GameController *)iter.second)->getSdlIndex() == sdlIndex) {
-				return true;
-			}
+// new chunks hand out blocks in address order so the first devices share one
+// contiguous chunk, C++11 new ignores over alignment so chunks are aligned by
+// hand
+DeviceState* DeviceManager::takeStateBlock() {
+	if(m_freeStates.empty()) {
+		const size_t count = 16;
+		m_stateChunks.emplace_back(sizeof(DeviceState) * count + 63);
+		uintptr_t start = ((uintptr_t)m_stateChunks.back().data() + 63) & ~(uintptr_t)63;
+		DeviceState *blocks = (DeviceState *)start;
+		for(size_t i = count; i > 0; --i) {
+			m_freeStates.push_back(&blocks[i - 1]);
 		}
-		else if(iter.second->getType() == JOYSTICK) {
-			if(((Joystick *)iter.second)->getSdlIndex() == sdlIndex) {
-				return true;
-			}
+	}
+	DeviceState *block = new(m_freeStates.back()) DeviceState();
+	m_freeStates.pop_back();
+	return block;
+}
+
+void DeviceManager::releaseStateBlock(DeviceState *block) {
+	if(!block) {return;}
+	for(auto &chunk : m_stateChunks) { // only blocks from the chunks
+		if((char *)block >= chunk.data() && (char *)block < chunk.data() + chunk.size()) {
+			m_freeStates.push_back(block);
+			return;
 		}
 	}
-	return false;
 }
 
-DeviceType DeviceManager::getDeviceType(int index) {
-	auto iter = m_devices.find(index);
-	if(iter != m_devices.end()) {
-		return iter->second->getType();
+void DeviceManager::registerDevice(Device *device) {
+	int index = device->getIndex();
+	if((size_t)index >= m_indices.size()) {
+		m_indices.resize(index + 1, nullptr);
 	}
-	return UNKNOWN;
+	m_indices[index] = device;
+	m_devices[device->getInstanceID()] = device;
+	m_addresses[device->getAddress()] = device;
+}
+
+void DeviceManager::unregisterDevice(Device *device) {
+	m_devices.erase(device->getInstanceID());
+	m_addresses.erase(device->getAddress());
+	int index = device->getIndex();
+	if((size_t)index < m_indices.size() && m_indices[index] == device) {
+		m_indices[index] = nullptr;
+		releaseIndex(index);
+	}
+}
+
+// freed indices are kept in a min heap so the lowest is reused first, ie. a
+// replugged js0 gets index 0 again
+int DeviceManager::takeIndex() {
+	if(!m_freeIndices.empty()) {
+		int index = m_freeIndices.top();
+		m_freeIndices.pop();
+		return index;
+	}
+	m_indices.push_back(nullptr);
+	return (int)m_indices.size() - 1;
+}
+
+void DeviceManager::releaseIndex(int index) {
+	if(index < 0 || (size_t)index >= m_indices.size()) {return;}
+	m_freeIndices.push(index);
+}
+
+// the SDL index may have shifted by the time the device is opened, so keep
+// the instance ID
+void DeviceManager::queueOpen(int sdlIndex) {
+	SDL_JoystickID instanceID = SDL_JoystickGetDeviceInstanceID(sdlIndex);
+	if(instanceID < 0 || find(instanceID) || !m_pendingIDs.insert(instanceID).second) {
+		return; // ignore duplicates
+	}
+	PendingOpen pending;
+	pending.instanceID = instanceID;
+	pending.sdlIndex = sdlIndex;
+	pending.added = SDL_GetPerformanceCounter();
+	m_pending.push_back(pending);
+}
+
+// SDL indices above a removed device shift down, so the queued index is
+// usually still valid & only a removal while the device waited forces a scan
+int DeviceManager::sdlIndexFor(const PendingOpen &pending) {
+	if(SDL_JoystickGetDeviceInstanceID(pending.sdlIndex) == pending.instanceID) {
+		return pending.sdlIndex;
+	}
+	for(int i = MIN(pending.sdlIndex, SDL_NumJoysticks() - 1); i >= 0; --i) {
+		if(SDL_JoystickGetDeviceInstanceID(i) == pending.instanceID) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void DeviceManager::printOpenTime(Device *device, Uint64 duration, Uint64 work) {
+	double frequency = (double)SDL_GetPerformanceFrequency();
+	LOG_VERBOSE << "DeviceManager: " << device->getAddress() << " open took "
+	            << (duration * 1000.0 / frequency) << " ms, "
+	            << (work * 1000.0 / frequency) << " ms of work" << std::endl;
+}
+
+// SDL indices shift as devices are removed, so look up the instance ID
+bool DeviceManager::sdlIndexExists(int sdlIndex) {
+	return m_devices.find(SDL_JoystickGetDeviceInstanceID(sdlIndex)) != m_devices.end();
 }
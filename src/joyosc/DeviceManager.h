@@ -23,12 +23,22 @@
 #pragma once
 
 #include <string>
+#include <mutex>
+#include <atomic>
+#include <queue>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 #include "Device.h"
 #include "DeviceSettingsMap.h"
 #include "DeviceExclusion.h"
 
 /// \class DeviceManager
 /// \brief Manages a active game controller & joystick devices
+///
+/// Active devices are registered by SDL instance ID, device index, & OSC
+/// address so event dispatch & queries are constant time lookups. Freed
+/// device indices are reused lowest first.
 class DeviceManager {
 
 	public:
@@ -46,6 +56,8 @@ class DeviceManager {
 		///
 		/// ignores duplicates which will occur since both the GameController &
 		/// the Joystick subsystems will report an add event for the same device
+		///
+		/// opens & finishes opening right away, see queueOpen() for hotplugging
 		bool open(int sdlIndex);
 
 		/// close game controller or joystick with SDL instance ID (different from index),
@@ -55,6 +67,20 @@ class DeviceManager {
 		/// the Joystick subsystems will report an add event for the same device
 		bool close(SDL_JoystickID instanceID);
 
+		/// queue game controller or joystick at SDL index to be opened by
+		/// openPending(), ignores duplicates
+		void queueOpen(int sdlIndex);
+
+		/// take the next step in opening queued devices, if any: open the
+		/// next device or finish opening it, see Device::finishOpen()
+		///
+		/// call once per loop iteration so opening a hotplugged device,
+		/// which may take a while, does not stall events from open devices
+		void openPending();
+
+		/// returns true if devices are waiting in the open queue
+		inline bool isOpening() {return !m_pending.empty();}
+
 		/// opens all currently connected devices
 		void openAll();
 
@@ -77,12 +103,31 @@ class DeviceManager {
 		Device* get(const std::string &address);
 
 		/// get device by it's index
-		/// note: slower than get(std::string)
-		Device* get(int index);
+		inline Device* get(int index) {
+			return ((size_t)index < m_indices.size() ? m_indices[index] : nullptr);
+		}
 
 		/// send device query info
 		void sendDeviceInfo(Device *device);
 
+		/// send current input state for all devices
+		void sendStates();
+
+		/// send a keyframe for all devices
+		void sendKeyframes();
+
+		/// request a keyframe for a device by address, ie. "/gc0", or "" for
+		/// all devices, sent by the next sendRequestedKeyframes() call
+		/// note: thread safe
+		void requestKeyframe(const std::string &address);
+
+		/// send requested keyframes, if any
+		void sendRequestedKeyframes();
+
+		/// set the base OSC sending address for devices & update the send
+		/// paths of all open devices
+		void setDeviceAddress(const std::string &address);
+
 		/// print active joystick list
 		void print(bool details=false);
 
@@ -113,20 +158,57 @@ class DeviceManager {
 
 	protected:
 
+		/// a hotplugged device waiting to be opened
+		struct PendingOpen {
+			SDL_JoystickID instanceID = -1; ///< SDL instance ID, SDL indices may shift
+			int sdlIndex = -1; ///< SDL index when queued, checked against instanceID
+			Device *device = nullptr; ///< opened device waiting to finish, if any
+			Uint64 added = 0; ///< queue time, see SDL_GetPerformanceCounter()
+			Uint64 work = 0; ///< time spent opening in performance counter ticks
+		};
+
+		/// open & register device at SDL index without finishing, returns
+		/// device or nullptr if not opened, see open()
+		Device* openDevice(int sdlIndex);
+
+		/// returns the current SDL index for a pending device or -1 if not found,
+		/// only scans the SDL devices if indices shifted after it was queued
+		int sdlIndexFor(const PendingOpen &pending);
+
+		/// print open duration & time spent opening in performance counter
+		/// ticks, if verbose
+		void printOpenTime(Device *device, Uint64 duration, Uint64 work);
+
+		/// add an opened device to the registry
 		void registerDevice(Device *device);
+
+		/// remove a device from the registry & free its index
 		void unregisterDevice(Device *device);
 
 		/// create default address using index, ex. "/gc1"
 		std::string addressForIndex(DeviceType type, int index);
 
-		/// return the first available index in the active devices list
-		int firstAvailableIndex();
+		/// take the lowest free device index
+		int takeIndex();
+
+		/// free a device index for reuse
+		void releaseIndex(int index);
 
 		/// is an sdlIndex already in use by an active device?
 		bool sdlIndexExists(int sdlIndex);
 
-		/// get the active device type at for an instanceID
-		DeviceType getDeviceType(int instanceID);
+		/// get the active device for an instanceID or nullptr if not found
+		inline Device* find(SDL_JoystickID instanceID) {
+			auto iter = m_devices.find(instanceID);
+			return (iter != m_devices.end() ? iter->second : nullptr);
+		}
+
+		/// take a free device state block, blocks are allocated contiguously
+		/// in cache line aligned chunks & never move
+		DeviceState* takeStateBlock();
+
+		/// return a device state block to the free list
+		void releaseStateBlock(DeviceState *block);
 
 		/// OSC receiver thread
 		lo::ServerThread *m_receiver = nullptr;
@@ -138,8 +220,28 @@ class DeviceManager {
 		DeviceExclusion m_deviceExclusion;
 
 		/// active devices, mapped by instanceID
-		std::map<int,Device *> m_devices;
+		std::unordered_map<SDL_JoystickID,Device *> m_devices;
+
+		/// active devices by device index, nullptr if free
+		std::vector<Device *> m_indices;
+
+		/// freed device indices below m_indices.size(), lowest first
+		std::priority_queue<int,std::vector<int>,std::greater<int>> m_freeIndices;
+
+		/// requested keyframe device addresses, "" for all
+		std::vector<std::string> m_keyframeRequests;
+		std::vector<std::string> m_keyframesToSend; ///< requests being sent, reused
+		std::mutex m_keyframeMutex; ///< keyframe requests mutex
+		std::atomic<bool> m_keyframesRequested{false}; ///< any keyframe requests?
+
+		/// hotplugged devices waiting to be opened, in order
+		std::deque<PendingOpen> m_pending;
+		std::unordered_set<SDL_JoystickID> m_pendingIDs; ///< instance IDs in m_pending
 
 		/// active devices, mapped by OSC addresses
-		std::map<std::string,Device *> m_addresses;
+		std::unordered_map<std::string,Device *> m_addresses;
+
+		/// device state block chunks, over allocated for cache line alignment
+		std::vector<std::vector<char>> m_stateChunks;
+		std::vector<DeviceState *> m_freeStates; ///< free state blocks, next last
 };
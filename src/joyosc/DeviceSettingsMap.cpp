@@ -119,6 +119,12 @@ bool DeviceSettingsMap::readXMLController(XMLElement *e) {
 	DeviceSettings device;
 	device.type = GAMECONTROLLER;
 	device.address = addr;
+	bool inputAddresses = false;
+	if(e->QueryBoolAttribute("inputAddresses", &inputAddresses) == XML_SUCCESS) {
+		device.inputAddresses = inputAddresses;
+		LOG_DEBUG << "<controller> " << name << " "
+		          << "input addresses " << inputAddresses << std::endl;
+	}
 	GameControllerSettings *gc = new GameControllerSettings();
 	device.data = (void *)gc;
 
@@ -248,6 +254,12 @@ bool DeviceSettingsMap::readXMLJoystick(XMLElement *e) {
 	DeviceSettings device;
 	device.type = JOYSTICK;
 	device.address = addr;
+	bool inputAddresses = false;
+	if(e->QueryBoolAttribute("inputAddresses", &inputAddresses) == XML_SUCCESS) {
+		device.inputAddresses = inputAddresses;
+		LOG_DEBUG << "<joystick> " << name << " "
+		          << "input addresses " << inputAddresses << std::endl;
+	}
 	XMLElement *child = e->FirstChildElement();
 	while(child) {
 		if((std::string)child->Name() == "axes") {
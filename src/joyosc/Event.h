@@ -26,12 +26,42 @@
 
 class Device;
 
-/// supported device types
+/// supported event types
 enum EventType {
 	BUTTON,
 	AXIS,
 	BALL,
-	HAT
+	HAT,
+	TOUCHPAD,
+	SENSOR
+};
+
+/// number of event types
+#define EVENT_TYPE_COUNT (SENSOR + 1)
+
+/// \struct EventRecord
+/// \brief compact, fixed-size device event record
+///
+/// Records are created by the device event handlers and serialized to OSC by
+/// the Sender, possibly on another thread. Strings are interned or static so
+/// a record stays valid even if the device which created it has been closed.
+/// The send path is prebuilt by the device so no strings are built per event.
+struct EventRecord {
+	EventType type = BUTTON;       ///< input type
+	const char *path = nullptr;    ///< interned send path ie. "/joyosc/devices/gc0/button",
+	                               ///< nullptr marks a bundle flush in the sender queue
+	const char *address = nullptr; ///< interned device address ie. "/gc0", for send filters
+	int device = 0;                ///< device list index, for binary frames
+	const char *name = nullptr;    ///< input, touch event, or sensor name or nullptr to send id
+	int id = 0;                    ///< input index, sensor type, or touch event type,
+	                               ///< numeric id for named inputs or -1 if none
+	bool isFloat = false;          ///< send float values? ie. normalized axis
+	bool inputPath = false;        ///< path includes the input name or id, so it is not sent
+	int ivalues[3] = {0, 0, 0};    ///< button state, axis value, ball x & y, etc
+	float fvalues[3] = {0, 0, 0};  ///< normalized axis value, sensor x, y, & z, etc
+	uint32_t timestamp = 0;        ///< SDL event timestamp in ms
+	uint32_t timestampUS = 0;      ///< us within the timestamp ms, if known, ie. sensors
+	uint32_t sequence = 0;         ///< per-device sequence number, 0 if not syncing
 };
 
 /// \class EventIgnore
@@ -23,7 +23,7 @@
 #include "GameController.h"
 
 #include <cmath> // M_2_PI
-#include <regex>
+#include <cstring>
 #include "../shared.h"
 #include "GameControllerRemapping.h"
 #include "GameControllerIgnore.h"
@@ -32,11 +32,13 @@
 bool GameController::triggersAsAxes = false;
 bool GameController::enableSensors = false;
 unsigned int GameController::sensorRateMS = 0;
+bool GameController::numericIds = false;
 
 GameController::GameController(std::string address) : Device(address) {
 	m_triggersAsAxes = GameController::triggersAsAxes;
 	m_enableSensors = GameController::enableSensors;
-	m_sensorRateMS = GameController::sensorRateMS;
+	m_state->sensorRateMS = GameController::sensorRateMS;
+	selectHandler();
 }
 
 bool GameController::open(DeviceIndex index, DeviceSettings *settings) {
@@ -63,10 +65,8 @@ bool GameController::open(DeviceIndex index, DeviceSettings *settings) {
 	m_instanceID = SDL_JoystickInstanceID(joystick);
 	m_name = SDL_GameControllerName(m_controller);
 
-	// create prev axis values
-	for(int i = 0; i < SDL_JoystickNumAxes(joystick); ++i) {
-		m_prevAxisValues.push_back(0);
-	}
+	// create state, uses SDL standard button & axis indices
+	setStateSize(SDL_CONTROLLER_AXIS_MAX, 0);
 
 	// apply settings?
 	if(settings) {
@@ -74,9 +74,7 @@ bool GameController::open(DeviceIndex index, DeviceSettings *settings) {
 		// try to set the address from the mapping list using the dev name,
 		// replace # with index if found
 		if(settings->address != "") {
-			std::stringstream stream;
-			stream << index.index;
-			m_address = std::regex_replace(settings->address, std::regex("#"), stream.str());
+			setAddress(addressWithIndex(settings->address, index.index));
 		}
 
 		// set axis dead zone if one exists
@@ -99,20 +97,24 @@ bool GameController::open(DeviceIndex index, DeviceSettings *settings) {
 		GameControllerSettings *gcs = (GameControllerSettings *)settings->data;
 		m_triggersAsAxes = gcs->triggersAsAxes;
 		m_enableSensors = gcs->enableSensors;
-		m_sensorRateMS = gcs->sensorRateMS;
+		m_state->sensorRateMS = gcs->sensorRateMS;
 		m_extendedMappings = (m_remapping ? m_remapping->hasExtended() : false);
+		if(settings->inputAddresses > -1) {
+			setInputAddresses(settings->inputAddresses);
+		}
 
-		// set color?
+		// set color in finishOpen()?
 		if(gcs->isColorValid()) {
-			setColor(gcs->ledColor[0],
-			         gcs->ledColor[1],
-			         gcs->ledColor[2]);
+			m_ledColor[0] = gcs->ledColor[0];
+			m_ledColor[1] = gcs->ledColor[1];
+			m_ledColor[2] = gcs->ledColor[2];
 		}
 	}
 
-	if(m_enableSensors) {
-		enableAvailableSensors();
-	}
+	compileInputs();
+	addInputPaths();
+	selectHandler();
+	publishState();
 
 	if(Device::printEvents) {
 		LOG << "GameController: opened ";
@@ -124,7 +126,21 @@ bool GameController::open(DeviceIndex index, DeviceSettings *settings) {
 	return true;
 }
 
+// sensors & the LED are set over the device connection, which may be slow
+// for wireless controllers
+void GameController::finishOpen() {
+	if(!m_controller) {return;}
+	if(m_enableSensors) {
+		enableAvailableSensors();
+	}
+	if(m_ledColor[0] > -1) {
+		setColor(m_ledColor[0], m_ledColor[1], m_ledColor[2]);
+		m_ledColor[0] = m_ledColor[1] = m_ledColor[2] = -1;
+	}
+}
+
 void GameController::close() {
+	unpublishState();
 	if(m_controller) {
 		if(isOpen()) {
 			SDL_GameControllerClose(m_controller);
@@ -146,75 +162,102 @@ void GameController::close() {
 	m_index.clear();
 	m_instanceID = -1;
 	m_name = "";
-	m_prevAxisValues.clear();
+	m_state->clearInputs();
 }
 
 bool GameController::handleEvent(SDL_Event *event) {
 	if(event == nullptr) {
 		return false;
 	}
+	return (this->*s_handlers[m_handlerIndex.load(std::memory_order_relaxed)])(event);
+}
+
+const GameController::Handler GameController::s_handlers[8] = {
+	&GameController::handle<false, false, false>,
+	&GameController::handle<false, false, true>,
+	&GameController::handle<false, true, false>,
+	&GameController::handle<false, true, true>,
+	&GameController::handle<true, false, false>,
+	&GameController::handle<true, false, true>,
+	&GameController::handle<true, true, false>,
+	&GameController::handle<true, true, true>
+};
+
+void GameController::selectHandler() {
+	m_handlerIndex = (m_normalizeAxes ? 4 : 0) | (m_triggersAsAxes ? 2 : 0) |
+	                 (printEvents ? 1 : 0);
+}
+
+// the compiler drops the branches & printing for unset flags
+template<bool normalize, bool triggersAsAxes, bool print>
+bool GameController::handle(SDL_Event *event) {
 	switch(event->type) {
 
 		case SDL_CONTROLLERBUTTONDOWN: case SDL_CONTROLLERBUTTONUP: {
-			std::string button = SDL_GameControllerGetStringForButton((SDL_GameControllerButton)event->cbutton.button);
-			return buttonPressed(button, event->cbutton.state);
+			const InputRule *rule = inputRule(BUTTON, event->cbutton.button);
+			if(!rule || rule->ignored) {break;}
+			buttonPressed<print>(rule->name, rule->id, rule->path,
+			                     event->cbutton.state, event->cbutton.timestamp);
+			setButtonState(event->cbutton.button, event->cbutton.state == SDL_PRESSED);
+			return true;
 		}
 
 		case SDL_CONTROLLERAXISMOTION: {
-			std::string axis = SDL_GameControllerGetStringForAxis((SDL_GameControllerAxis)event->caxis.axis);
-
-			if(m_ignore && m_ignore->isIgnored(AXIS, axis)) {
+			const InputRule *rule = inputRule(AXIS, event->caxis.axis);
+			if(!rule || rule->ignored || (!triggersAsAxes && rule->triggerIgnored)) {
 				break;
 			}
-			if(m_remapping) {
-				axis = m_remapping->get(AXIS, axis);
-			}
 
 			// handle jitter by creating a dead zone
 			int value = (int)event->caxis.value;
-			if(abs(value) < m_axisDeadZone) {
+			if(abs(value) < m_state->axisDeadZone) {
 				value = 0;
 			}
 
+			// state keeps triggers as axes
+			setAxisState(event->caxis.axis, value);
+
 			// trigger buttons for some devices are reported as axis values,
 			// forward them as buttons unless desired as axes
-			bool isButton = (!m_triggersAsAxes && (axis == "lefttrigger" || axis == "righttrigger"));
+			bool isButton = (!triggersAsAxes && rule->triggerName);
 			if(isButton) {
 				value = (event->caxis.value > 0 ? 1 : 0);
 			}
 
 			// make sure we don't report a value more than once
-			if(m_prevAxisValues[event->caxis.axis] == value) {
+			if(isAxisRepeat(event->caxis.axis, value)) {
 				return true;
 			}
 
-			// store value
-			m_prevAxisValues[event->caxis.axis] = value;
-
 			// send
 			if(isButton) {
-				m_prevAxisValues[event->caxis.axis] = value;
-				return buttonPressed(axis, value);
+				buttonPressed<print>(rule->triggerName, rule->triggerId, rule->triggerPath,
+				                     value, event->caxis.timestamp);
+				return true;
 			}
-			axisMoved(axis, value);
+			axisMoved<normalize, print>(rule->name, rule->id, rule->path,
+			                            value, event->caxis.timestamp);
 
 			return true;
 		}
 
 		case SDL_CONTROLLERTOUCHPADDOWN: case SDL_CONTROLLERTOUCHPADMOTION:
 		case SDL_CONTROLLERTOUCHPADUP: {
-			const std::string &action = touchEventName((SDL_EventType)event->type);
-			sender->send(Device::deviceAddress + m_address + "/touchpad",
-				"siifff", action.c_str(),
-				event->ctouchpad.touchpad,
-				event->ctouchpad.finger,
-				event->ctouchpad.x,
-				event->ctouchpad.y,
-				event->ctouchpad.pressure
-			);
-			if(Device::printEvents) {
+			EventRecord record;
+			record.type = TOUCHPAD;
+			record.path = m_sendPaths[TOUCHPAD];
+			record.name = touchEventName((SDL_EventType)event->type);
+			record.id = (int)event->type;
+			record.ivalues[0] = event->ctouchpad.touchpad;
+			record.ivalues[1] = event->ctouchpad.finger;
+			record.fvalues[0] = event->ctouchpad.x;
+			record.fvalues[1] = event->ctouchpad.y;
+			record.fvalues[2] = event->ctouchpad.pressure;
+			record.timestamp = event->ctouchpad.timestamp;
+			sendRecord(record, m_touchpadPaths[event->type - SDL_CONTROLLERTOUCHPADDOWN]);
+			if(print) {
 				LOG << m_address << " " << m_name
-				    << " touchpad: " << action
+				    << " touchpad: " << touchEventName((SDL_EventType)event->type)
 				    << " " << event->ctouchpad.touchpad
 				    << " " << event->ctouchpad.finger
 				    << " " << event->ctouchpad.x
@@ -226,62 +269,63 @@ bool GameController::handleEvent(SDL_Event *event) {
 
 		case SDL_CONTROLLERSENSORUPDATE: {
 			SDL_SensorType type = (SDL_SensorType)event->csensor.sensor;
-			const std::string &sensor = sensorName(type);
 			float x = cleanSensorValue(event->csensor.data[0]);
 			float y = cleanSensorValue(event->csensor.data[1]);
 			float z = cleanSensorValue(event->csensor.data[2]);
-			auto prev = m_prevSensorTimestamps.find(type);
-			if(prev != m_prevSensorTimestamps.end()) { // limit sensor rate
-				if(event->csensor.timestamp - prev->second < m_sensorRateMS) {
+			setSensorState(type, x, y, z); // latest, ignores rate limit
+			uint8_t bit = DeviceState::sensorBit(type);
+			if(m_state->sensorsLimited & bit) { // limit sensor rate
+				uint32_t &prev = m_state->sensorTimes[(int)type];
+				if(event->csensor.timestamp - prev < m_state->sensorRateMS) {
 					return true;
 				}
-				prev->second = event->csensor.timestamp;
+				prev = event->csensor.timestamp;
 			}
-			sender->send(Device::deviceAddress + m_address + "/sensor",
-				"sfff", sensor.c_str(), x, y, z);
-			if(Device::printEvents) {
-				LOG << m_address << " " << m_name << " sensor: " << sensor
-				    << " " << x << " " << y << " " << z << std::endl;
+			EventRecord record;
+			record.type = SENSOR;
+			record.path = m_sendPaths[SENSOR];
+			record.name = (numericIds ? nullptr : sensorName(type));
+			record.id = (int)type;
+			record.fvalues[0] = x;
+			record.fvalues[1] = y;
+			record.fvalues[2] = z;
+			record.timestamp = event->csensor.timestamp;
+#ifdef HAVE_SDL_CONTROLLERSENSOREVENT_TIMESTAMP_US
+			if(event->csensor.timestamp_us > 0) {
+				setSensorTimestamp(record, type, event->csensor.timestamp_us);
+			}
+#endif
+			sendRecord(record, (bit ? m_sensorPaths[(int)type] : nullptr));
+			if(print) {
+				LOG << m_address << " " << m_name << " sensor: " << sensorName(type)
+				    << " " << record.fvalues[0] << " " << record.fvalues[1]
+				    << " " << record.fvalues[2] << std::endl;
 			}
 			return true;
 		}
 
 		// extended joystick event
 		case SDL_JOYBUTTONDOWN: case SDL_JOYBUTTONUP: {
-			if(!m_remapping) {break;}
-			if(SDL_GameControllerHasButton(m_controller, (SDL_GameControllerButton)event->jbutton.button) == SDL_FALSE) {
-				std::string button = m_remapping->getExtended(BUTTON, (int)event->jbutton.button);
-				if(button != "") {
-					int value = (int)event->jbutton.state;
-					sender->send(Device::deviceAddress + m_address + "/button",
-						"si", button.c_str(), value);
-					if(Device::printEvents) {
-						LOG << m_address << " " << m_name
-						    << " button: " << button << " " << value << std::endl;
-					}
-					return true;
-				}
-			}
-			break;
+			size_t button = event->jbutton.button;
+			if(button >= m_extendedButtons.size() || m_extendedButtons[button].ignored) {break;}
+			const InputRule &rule = m_extendedButtons[button];
+			buttonPressed<print>(rule.name, rule.id, rule.path,
+			                     (int)event->jbutton.state, event->jbutton.timestamp);
+			return true;
 		}
 
 		// extended joystick event
 		// no ignore or dead zone handling, send raw value
 		case SDL_JOYAXISMOTION: {
-			if(!m_remapping) {break;}
-			if(SDL_GameControllerHasAxis(m_controller, (SDL_GameControllerAxis)event->jaxis.axis) == SDL_FALSE) {
-				std::string axis = m_remapping->getExtended(AXIS, (int)event->jaxis.axis);
-				if(axis != "") {
-					int value = (int)event->caxis.value;
-					if(m_prevAxisValues[event->caxis.axis] == value) {
-						return true;
-					}
-					m_prevAxisValues[event->jaxis.axis] = value;
-					axisMoved(axis, value);
-					return true;
-				}
+			size_t axis = event->jaxis.axis;
+			if(axis >= m_extendedAxes.size() || m_extendedAxes[axis].ignored) {break;}
+			const InputRule &rule = m_extendedAxes[axis];
+			int value = (int)event->jaxis.value;
+			if(isAxisRepeat((int)axis, value)) {
+				return true;
 			}
-			break;
+			axisMoved<normalize, print>(rule.name, rule.id, rule.path, value, event->jaxis.timestamp);
+			return true;
 		}
 	}
 	return false;
@@ -363,6 +407,7 @@ SDL_Joystick* GameController::getJoystick() {
 
 void GameController::setTriggersAsAxes(bool asAxes) {
 	m_triggersAsAxes = asAxes;
+	selectHandler();
 }
 
 void GameController::setColor(int r, int g, int b) {
@@ -404,12 +449,12 @@ int GameController::addMappingFile(std::string path) {
 	return ret;
 }
 
-std::string GameController::sensorName(SDL_SensorType sensor) {
+const char* GameController::sensorName(SDL_SensorType sensor) {
 	return shared::SensorName(sensor);
 }
 
 // naming matches RjDJ/PdParty #touch events
-std::string GameController::touchEventName(SDL_EventType type) {
+const char* GameController::touchEventName(SDL_EventType type) {
 	switch(type) {
 		case SDL_CONTROLLERTOUCHPADDOWN:   return "down";
 		case SDL_CONTROLLERTOUCHPADMOTION: return "xy";
@@ -418,6 +463,46 @@ std::string GameController::touchEventName(SDL_EventType type) {
 	}
 }
 
+// trigger buttons follow the SDL buttons as they are axes in SDL
+int GameController::buttonId(const char *name) {
+	SDL_GameControllerButton button = SDL_GameControllerGetButtonFromString(name);
+	if(button != SDL_CONTROLLER_BUTTON_INVALID) {return (int)button;}
+	if(strcmp(name, "lefttrigger") == 0) {return SDL_CONTROLLER_BUTTON_MAX;}
+	if(strcmp(name, "righttrigger") == 0) {return SDL_CONTROLLER_BUTTON_MAX + 1;}
+	return -1;
+}
+
+// one reply per input type: type name, then id & name pairs
+void GameController::sendSchema(const std::string &path) {
+	OscMessage message(path.c_str());
+	message.addString("button");
+	for(int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i) {
+		message.addInt32(i);
+		message.addString(SDL_GameControllerGetStringForButton((SDL_GameControllerButton)i));
+	}
+	message.addInt32(SDL_CONTROLLER_BUTTON_MAX);
+	message.addString("lefttrigger");
+	message.addInt32(SDL_CONTROLLER_BUTTON_MAX + 1);
+	message.addString("righttrigger");
+	sender->sendReply(message);
+
+	message.clear();
+	message.addString("axis");
+	for(int i = 0; i < SDL_CONTROLLER_AXIS_MAX; ++i) {
+		message.addInt32(i);
+		message.addString(SDL_GameControllerGetStringForAxis((SDL_GameControllerAxis)i));
+	}
+	sender->sendReply(message);
+
+	message.clear();
+	message.addString("sensor");
+	for(unsigned int i = 0; i < SDL_arraysize(shared::s_sensors); ++i) {
+		message.addInt32((int)shared::s_sensors[i]);
+		message.addString(sensorName(shared::s_sensors[i]));
+	}
+	sender->sendReply(message);
+}
+
 bool GameController::isSensorAccel(SDL_SensorType sensor) {
 	switch(sensor) {
 		case SDL_SENSOR_ACCEL:
@@ -457,6 +542,128 @@ float GameController::cleanSensorValue(float v) {
 
 // PROTECTED
 
+// paths must match the names or ids sent by the event handlers, trigger
+// button paths are built either way so triggers as axes can change later
+void GameController::addInputPaths() {
+	auto path = [this](EventType type, const char *name, int id) -> const char* {
+		if(numericIds && id > -1) {return buildInputPath(type, nullptr, id);}
+		return buildInputPath(type, name, 0);
+	};
+	for(auto &rule : m_inputRules[BUTTON]) {
+		rule.path = (rule.ignored ? nullptr : path(BUTTON, rule.name, rule.id));
+	}
+	for(auto &rule : m_inputRules[AXIS]) {
+		rule.path = (rule.ignored ? nullptr : path(AXIS, rule.name, rule.id));
+		if(rule.triggerName && !rule.triggerIgnored) {
+			rule.triggerPath = path(BUTTON, rule.triggerName, rule.triggerId);
+		}
+	}
+	for(auto &rule : m_extendedButtons) {
+		rule.path = (rule.ignored ? nullptr : path(BUTTON, rule.name, rule.id));
+	}
+	for(auto &rule : m_extendedAxes) {
+		rule.path = (rule.ignored ? nullptr : path(AXIS, rule.name, rule.id));
+	}
+	for(int i = 0; i < 3; ++i) {
+		m_touchpadPaths[i] = buildInputPath(TOUCHPAD,
+			touchEventName((SDL_EventType)(SDL_CONTROLLERTOUCHPADDOWN + i)), 0);
+	}
+	for(unsigned int i = 0; i < SDL_arraysize(shared::s_sensors); ++i) {
+		SDL_SensorType sensor = shared::s_sensors[i];
+		if(!DeviceState::sensorBit(sensor)) {continue;}
+		m_sensorPaths[(int)sensor] = path(SENSOR, sensorName(sensor), (int)sensor);
+	}
+}
+
+// names are interned so records can use the pointers, numeric ids are
+// resolved here so events need no string lookups
+void GameController::compileInputs() {
+	auto isIgnored = [this](EventType type, const char *name) {
+		return (m_ignore && m_ignore->isIgnored(type, std::string(name)));
+	};
+	auto remap = [this](EventType type, const char *name) {
+		return internString(m_remapping ? m_remapping->get(type, std::string(name)) : name);
+	};
+	auto compile = [&](InputRule &rule, EventType type, const char *name) {
+		if(!name) {
+			rule.ignored = true;
+			return;
+		}
+		rule.ignored = isIgnored(type, name);
+		rule.name = remap(type, name);
+		if(type == BUTTON) {
+			rule.id = buttonId(rule.name);
+		}
+		else {
+			rule.id = (int)SDL_GameControllerGetAxisFromString(rule.name);
+			if(strcmp(rule.name, "lefttrigger") == 0 || strcmp(rule.name, "righttrigger") == 0) {
+				// triggers sent as buttons follow the button ignores & remappings
+				rule.triggerIgnored = isIgnored(BUTTON, rule.name);
+				rule.triggerName = remap(BUTTON, rule.name);
+				rule.triggerId = buttonId(rule.triggerName);
+			}
+		}
+	};
+	m_inputRules[BUTTON].assign(SDL_CONTROLLER_BUTTON_MAX, InputRule());
+	for(int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i) {
+		compile(m_inputRules[BUTTON][i], BUTTON,
+		        SDL_GameControllerGetStringForButton((SDL_GameControllerButton)i));
+	}
+	m_inputRules[AXIS].assign(SDL_CONTROLLER_AXIS_MAX, InputRule());
+	for(int i = 0; i < SDL_CONTROLLER_AXIS_MAX; ++i) {
+		compile(m_inputRules[AXIS][i], AXIS,
+		        SDL_GameControllerGetStringForAxis((SDL_GameControllerAxis)i));
+	}
+
+	// joystick inputs which are not part of the controller mapping, extended
+	// buttons follow the button ignores & remappings by their mapped names
+	m_extendedButtons.clear();
+	m_extendedAxes.clear();
+	if(!m_extendedMappings) {return;}
+	SDL_Joystick *joystick = getJoystick();
+	m_extendedButtons.resize(MAX(SDL_JoystickNumButtons(joystick), 0));
+	for(int i = 0; i < (int)m_extendedButtons.size(); ++i) {
+		InputRule &rule = m_extendedButtons[i];
+		const std::string &button = m_remapping->getExtended(BUTTON, i);
+		rule.ignored = (button == "" ||
+			SDL_GameControllerHasButton(m_controller, (SDL_GameControllerButton)i) == SDL_TRUE ||
+			isIgnored(BUTTON, button.c_str()));
+		if(rule.ignored) {continue;}
+		rule.name = remap(BUTTON, button.c_str());
+		rule.id = buttonId(rule.name);
+	}
+	m_extendedAxes.resize(MAX(SDL_JoystickNumAxes(joystick), 0));
+	for(int i = 0; i < (int)m_extendedAxes.size(); ++i) {
+		InputRule &rule = m_extendedAxes[i];
+		const std::string &axis = m_remapping->getExtended(AXIS, i);
+		rule.ignored = (axis == "" ||
+			SDL_GameControllerHasAxis(m_controller, (SDL_GameControllerAxis)i) == SDL_TRUE);
+		if(rule.ignored) {continue;}
+		rule.name = internString(axis);
+		rule.id = (int)SDL_GameControllerGetAxisFromString(rule.name);
+	}
+}
+
+// the sensor clock has its own base, so it is anchored to the SDL event
+// time & re-anchored if it runs ahead of the event ms or lags by more than
+// 20 ms, ie. after a pause, offsets are kept in the device state block
+void GameController::setSensorTimestamp(EventRecord &record, SDL_SensorType type, uint64_t us) {
+	int64_t ticks = (int64_t)record.timestamp * 1000;
+	uint8_t bit = DeviceState::sensorBit(type);
+	if(!bit) {
+		return; // unknown sensor type, no offset kept so the event ms is used
+	}
+	int64_t &offset = m_state->sensorClockOffsets[(int)type];
+	int64_t time = ((m_state->sensorClocksSet & bit) ? (int64_t)us + offset : -1);
+	if(time < 0 || time > ticks + 1000 || time < ticks - 20000) {
+		offset = ticks - (int64_t)us;
+		m_state->sensorClocksSet |= bit;
+		time = ticks;
+	}
+	record.timestamp = (uint32_t)(time / 1000);
+	record.timestampUS = (uint32_t)(time % 1000);
+}
+
 void GameController::enableAvailableSensors() {
 	for(unsigned int i = 0; i < SDL_arraysize(shared::s_sensors); ++i) {
 		SDL_SensorType sensor = shared::s_sensors[i];
@@ -468,7 +675,9 @@ void GameController::enableAvailableSensors() {
 				         << ": " << SDL_GetError() << std::endl;
 				continue;
 			}
-			m_prevSensorTimestamps[sensor] = 0;
+			uint8_t bit = DeviceState::sensorBit(sensor);
+			m_state->sensorsLimited |= bit;
+			if(bit) {m_state->sensorTimes[(int)sensor] = 0;}
 		}
 	}
 }
@@ -484,43 +693,53 @@ void GameController::disableAvailableSensors() {
 				         << ": " << SDL_GetError() << std::endl;
 				continue;
 			}
-			//m_prevSensorTimestamps[sensor] = 0;
 		}
 	}
 }
 
-bool GameController::buttonPressed(std::string &button, int value) {
-	if(m_ignore && m_ignore->isIgnored(BUTTON, button)) {
-		return false;
-	}
-	if(m_remapping) {
-		button = m_remapping->get(BUTTON, button);
-	}
-
-	sender->send(Device::deviceAddress + m_address + "/button",
-		"si", button.c_str(), value);
-	
-	if(Device::printEvents) {
+template<bool print>
+void GameController::buttonPressed(const char *name, int id, const char *path,
+                                   int value, uint32_t timestamp) {
+	EventRecord record;
+	record.type = BUTTON;
+	record.path = m_sendPaths[BUTTON];
+	record.name = name;
+	record.id = id;
+	if(numericIds && id > -1) {record.name = nullptr;} // otherwise send name
+	record.ivalues[0] = value;
+	record.timestamp = timestamp;
+	sendRecord(record, path);
+
+	if(print) {
 		LOG << m_address << " " << m_name
-		    << " button: " << button << " " << value << std::endl;
+		    << " button: " << name << " " << value << std::endl;
 	}
-	return true;
 }
 
-void GameController::axisMoved(const std::string &name, int value) {
-	if(m_normalizeAxes) {
+template<bool normalize, bool print>
+void GameController::axisMoved(const char *name, int id, const char *path,
+                               int value, uint32_t timestamp) {
+	EventRecord record;
+	record.type = AXIS;
+	record.path = m_sendPaths[AXIS];
+	record.name = name;
+	record.id = id;
+	if(numericIds && id > -1) {record.name = nullptr;} // otherwise send name
+	record.timestamp = timestamp;
+	if(normalize) {
 		float scaled = Device::normalizeAxisValue(value);
-		sender->send(Device::deviceAddress + m_address + "/axis",
-			"sf", name.c_str(), scaled);
-		if(Device::printEvents) {
+		record.isFloat = true;
+		record.fvalues[0] = scaled;
+		sendRecord(record, path);
+		if(print) {
 			LOG << m_address << " " << m_name
 			    << " axis" << ": " << name << " " << scaled << std::endl;
 		}
 	}
 	else {
-		sender->send(Device::deviceAddress + m_address + "/axis",
-			"si", name.c_str(), value);
-		if(Device::printEvents) {
+		record.ivalues[0] = value;
+		sendRecord(record, path);
+		if(print) {
 			LOG << m_address << " " << m_name
 			    << " axis" << ": " << name << " " << value << std::endl;
 		}
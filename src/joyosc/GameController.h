@@ -22,6 +22,7 @@
 ==============================================================================*/
 #pragma once
 
+#include <atomic>
 #include "Device.h"
 
 class GameControllerRemapping;
@@ -57,6 +58,9 @@ class GameController : public Device {
 		/// returns	true on success
 		bool open(DeviceIndex index, DeviceSettings *settings=nullptr);
 
+		/// enable sensors & set the LED color, if set
+		void finishOpen();
+
 		/// close the controller
 		void close();
 
@@ -111,7 +115,7 @@ class GameController : public Device {
 
 		/// set the sensor rate in hz
 		inline void setSensorRate(int rate) {
-			m_sensorRateMS = (rate > 0 ? 1000 / rate : 0); // hz -> ms
+			m_state->sensorRateMS = (rate > 0 ? 1000 / rate : 0); // hz -> ms
 		}
 
 	/// \section static utils
@@ -125,10 +129,19 @@ class GameController : public Device {
 		static int addMappingFile(std::string path);
 
 		/// return sensor name from enum
-		static std::string sensorName(SDL_SensorType sensor);
+		static const char* sensorName(SDL_SensorType sensor);
 
 		/// return touchpad event from enum
-		static std::string touchEventName(SDL_EventType type);
+		static const char* touchEventName(SDL_EventType type);
+
+		/// returns the numeric id for a button name, the SDL button enum value
+		/// or SDL_CONTROLLER_BUTTON_MAX + 0/1 for the left & right trigger
+		/// buttons, returns -1 if the name is unknown
+		static int buttonId(const char *name);
+
+		/// send the numeric id schema as query replies to path, one per input
+		/// type: s type [i id s name]...
+		static void sendSchema(const std::string &path);
 
 		/// returns true if sensor type is an accelerometer
 		static bool isSensorAccel(SDL_SensorType sensor);
@@ -156,17 +169,60 @@ class GameController : public Device {
 		/// note: this is the shared default, may be overriden per-instance
 		static unsigned int sensorRateMS;
 
+	/// \section shared settings
+
+		/// send button, axis, & sensor ids instead of names? ids are the SDL
+		/// enum values, see sendSchema(), inputs without an id send names
+		static bool numericIds;
+
 	protected:
 
+		/// build per-input send paths for all buttons, axes, triggers,
+		/// touchpad events, & sensors
+		void addInputPaths();
+
+		/// set record timestamp from a sensor hardware timestamp in us mapped
+		/// onto the SDL event time, keeps the sensor's sample spacing
+		void setSensorTimestamp(EventRecord &record, SDL_SensorType type, uint64_t us);
+
 		/// enable (available) controller sensors
 		void enableAvailableSensors();
 		void disableAvailableSensors();
 
-		/// send button event
-		bool buttonPressed(std::string &name, int value);
+		/// compile button & axis remappings & ignores by SDL id, & extended
+		/// mappings by joystick index
+		void compileInputs();
+
+		/// select the handleEvent() instantiation for the current flags
+		void selectHandler();
+
+		/// event handler with the flags as template parameters
+		template<bool normalize, bool triggersAsAxes, bool print>
+		bool handle(SDL_Event *event);
 
-		/// send axis event
-		void axisMoved(const std::string &name, int value);
+		/// event handler member function
+		typedef bool (GameController::*Handler)(SDL_Event *event);
+
+		/// handle() instantiations by flag index, see selectHandler()
+		static const Handler s_handlers[8];
+
+		/// send button event with the numeric id or -1 if none & the per-input
+		/// send path, if any
+		/// note: name must be interned, see compileInputs()
+		template<bool print>
+		void buttonPressed(const char *name, int id, const char *path,
+		                   int value, uint32_t timestamp);
+
+		/// send axis event with the numeric id or -1 if none & the per-input
+		/// send path, if any
+		/// note: name must be interned, see compileInputs()
+		template<bool normalize, bool print>
+		void axisMoved(const char *name, int id, const char *path,
+		               int value, uint32_t timestamp);
+
+		/// selected s_handlers index, atomic as flags may be changed from the
+		/// OSC receiver thread while handling events
+		std::atomic<int> m_handlerIndex{0};
 
 		/// SDL controller handle
 		SDL_GameController *m_controller = nullptr;
@@ -177,12 +233,21 @@ class GameController : public Device {
 		/// are extended joystick events supported?
 		bool m_extendedMappings = false;
 
+		/// compiled extended mappings by joystick button index, ignored if none
+		std::vector<InputRule> m_extendedButtons;
+
+		/// compiled extended mappings by joystick axis index, ignored if none
+		std::vector<InputRule> m_extendedAxes;
+
 		/// enable sensor events (accelerometer, gyro)
 		bool m_enableSensors = false;
 
-		///< prev sensor timestamps for rate limit
-		std::map<SDL_SensorType,uint32_t> m_prevSensorTimestamps;
+		/// per-input touchpad send paths by event type from touchpad down
+		const char *m_touchpadPaths[3] = {nullptr, nullptr, nullptr};
 
-		/// sensor rate limit in ms between frames, 0 for unlimited
-		unsigned int m_sensorRateMS = 0;
+		/// per-input sensor send paths by sensor type, nullptr if unknown
+		const char *m_sensorPaths[DEVICE_STATE_MAX_SENSORS] = {nullptr};
+
+		/// LED color to set in finishOpen(), -1 if none
+		int m_ledColor[3] = {-1, -1, -1};
 };
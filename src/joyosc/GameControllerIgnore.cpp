@@ -63,7 +63,7 @@ void GameControllerIgnore::check(Device *device) {
 	}
 	auto iter = buttons.begin();
 	for(; iter != buttons.end();) {
-		if(SDL_GameControllerGetButtonFromString((*iter).c_str()) == SDL_CONTROLLER_BUTTON_INVALID) {
+		if(GameController::buttonId((*iter).c_str()) < 0) { // includes triggers
 			LOG_WARN << "GameController " << controller->getName() << ": "
 			         << "removing invalid button ignore: " << (*iter) << std::endl;
 			iter = buttons.erase(iter);
@@ -87,7 +87,7 @@ void GameControllerRemapping::check(Device *device) {
 	}
 
 	for(auto iter = buttons.begin(); iter != buttons.end();) {
-		if(SDL_GameControllerGetButtonFromString(iter->first.c_str()) == SDL_CONTROLLER_BUTTON_INVALID) {
+		if(GameController::buttonId(iter->first.c_str()) < 0) { // includes triggers
 			LOG_WARN << "GameController " << controller->getName() << ": "
 			         << "removing invalid button remap: "
 			         << iter->first << " -> " << iter->second << std::endl;
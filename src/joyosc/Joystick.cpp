@@ -22,12 +22,13 @@
 ==============================================================================*/
 #include "Joystick.h"
 
-#include <regex>
 #include "../shared.h"
 #include "JoystickIgnore.h"
 #include "JoystickRemapping.h"
 
-Joystick::Joystick(std::string address) : Device(address) {}
+Joystick::Joystick(std::string address) : Device(address) {
+	selectHandler();
+}
 
 bool Joystick::open(DeviceIndex index, DeviceSettings *settings) {
 	if(!index.isValid()) {
@@ -51,20 +52,9 @@ bool Joystick::open(DeviceIndex index, DeviceSettings *settings) {
 
 	m_instanceID = SDL_JoystickInstanceID(m_joystick);
 	m_name = SDL_JoystickName(m_joystick);
-	if(SDL_JoystickIsHaptic(m_joystick) == SDL_TRUE) {
-		m_haptic = SDL_HapticOpenFromJoystick(m_joystick);
-		if(m_haptic) {
-			if(SDL_HapticRumbleInit(m_haptic) == SDL_FALSE) {
-				LOG_WARN << "Joystick: haptic rumble init failed for index "
-				         << m_index.index << ": " << SDL_GetError() << std::endl;
-			}
-		}
-	}
 
-	// create prev axis values
-	for(int i = 0; i < SDL_JoystickNumAxes(m_joystick); ++i) {
-		m_prevAxisValues.push_back(0);
-	}
+	// create state
+	setStateSize(SDL_JoystickNumAxes(m_joystick), SDL_JoystickNumHats(m_joystick));
 
 	// apply settings?
 	if(settings) {
@@ -72,9 +62,7 @@ bool Joystick::open(DeviceIndex index, DeviceSettings *settings) {
 		// try to set the address from the mapping list using the dev name,
 		// replace # with index if found
 		if(settings->address != "") {
-			std::stringstream stream;
-			stream << index.index;
-			m_address = std::regex_replace(settings->address, std::regex("#"), stream.str());
+			setAddress(addressWithIndex(settings->address, index.index));
 		}
 
 		// set axis dead zone if one exists
@@ -93,8 +81,18 @@ bool Joystick::open(DeviceIndex index, DeviceSettings *settings) {
 			setIgnore((JoystickIgnore *)settings->ignore);
 			printIgnores();
 		}
+
+		// overrides
+		if(settings->inputAddresses > -1) {
+			setInputAddresses(settings->inputAddresses);
+		}
 	}
 
+	compileInputs();
+	addInputPaths();
+	selectHandler();
+	publishState();
+
 	if(Device::printEvents) {
 		LOG << "Joystick: opened ";
 		print();
@@ -105,7 +103,22 @@ bool Joystick::open(DeviceIndex index, DeviceSettings *settings) {
 	return true;
 }
 
+// haptic devices may take a while to open
+void Joystick::finishOpen() {
+	if(!m_joystick || m_haptic) {return;}
+	if(SDL_JoystickIsHaptic(m_joystick) == SDL_TRUE) {
+		m_haptic = SDL_HapticOpenFromJoystick(m_joystick);
+		if(m_haptic) {
+			if(SDL_HapticRumbleInit(m_haptic) == SDL_FALSE) {
+				LOG_WARN << "Joystick: haptic rumble init failed for index "
+				         << m_index.index << ": " << SDL_GetError() << std::endl;
+			}
+		}
+	}
+}
+
 void Joystick::close() {
+	unpublishState();
 	if(m_haptic) {
 		SDL_HapticClose(m_haptic);
 		m_haptic = nullptr;
@@ -127,46 +140,48 @@ void Joystick::close() {
 	m_index.clear();
 	m_instanceID = -1;
 	m_name = "";
-	m_prevAxisValues.clear();
+	m_state->clearInputs();
 }
 
 bool Joystick::handleEvent(SDL_Event *event) {
 	if(event == nullptr) {
 		return false;
 	}
-	switch(event->type) {
-		
-		case SDL_JOYBUTTONDOWN: {
-			if(m_ignore && m_ignore->isIgnored(BUTTON, event->jbutton.button)) {
-				break;
-			}
-			if(m_remapping) {
-				event->jbutton.button = m_remapping->get(BUTTON, event->jbutton.button);
-			}
+	return (this->*s_handlers[m_handlerIndex.load(std::memory_order_relaxed)])(event);
+}
 
-			sender->send(Device::deviceAddress + m_address + "/button",
-				"ii", (int)event->jbutton.button, (int)event->jbutton.state);
+const Joystick::Handler Joystick::s_handlers[4] = {
+	&Joystick::handle<false, false>, &Joystick::handle<false, true>,
+	&Joystick::handle<true, false>, &Joystick::handle<true, true>
+};
 
-			if(printEvents) {
-				LOG << m_address << " " << m_name
-				    << " button: " << (int)event->jbutton.button
-				    << " " << (int)event->jbutton.state << std::endl;
-			}
-			return true;
-		}
+void Joystick::selectHandler() {
+	m_handlerIndex = (m_normalizeAxes ? 2 : 0) | (printEvents ? 1 : 0);
+}
 
-		case SDL_JOYBUTTONUP: {
-			if(m_ignore && m_ignore->isIgnored(BUTTON, event->jbutton.button)) {
+// the compiler drops the branches & printing for unset flags
+template<bool normalize, bool print>
+bool Joystick::handle(SDL_Event *event) {
+	EventRecord record;
+	record.timestamp = event->common.timestamp;
+	switch(event->type) {
+
+		case SDL_JOYBUTTONDOWN: case SDL_JOYBUTTONUP: {
+			const InputRule *rule = inputRule(BUTTON, event->jbutton.button);
+			if(!rule || rule->ignored) {
 				break;
 			}
-			if(m_remapping) {
-				event->jbutton.button = m_remapping->get(BUTTON, event->jbutton.button);
-			}
+			event->jbutton.button = rule->id;
+
+			setButtonState(event->jbutton.button, event->jbutton.state == SDL_PRESSED);
 
-			sender->send(Device::deviceAddress + m_address + "/button",
-				"ii", (int)event->jbutton.button, (int)event->jbutton.state);
+			record.type = BUTTON;
+			record.path = m_sendPaths[BUTTON];
+			record.id = (int)event->jbutton.button;
+			record.ivalues[0] = (int)event->jbutton.state;
+			sendRecord(record, rule->path);
 
-			if(printEvents) {
+			if(print) {
 				LOG << m_address << " " << m_name
 				    << " button: " << (int)event->jbutton.button
 				    << " " << (int)event->jbutton.state << std::endl;
@@ -175,42 +190,43 @@ bool Joystick::handleEvent(SDL_Event *event) {
 		}
 
 		case SDL_JOYAXISMOTION: {
-			if(m_ignore && m_ignore->isIgnored(AXIS, event->jaxis.axis)) {
+			const InputRule *rule = inputRule(AXIS, event->jaxis.axis);
+			if(!rule || rule->ignored) {
 				break;
 			}
-			if(m_remapping) {
-				event->jaxis.axis = m_remapping->get(AXIS, event->jaxis.axis);
-			}
+			event->jaxis.axis = rule->id;
 
 			// handle jitter by creating a dead zone
 			int value = (int)event->jaxis.value;
-			if(abs(value) < m_axisDeadZone) {
+			if(abs(value) < m_state->axisDeadZone) {
 				value = 0;
 			}
 
 			// make sure we don't report a value more than once
-			if(m_prevAxisValues[event->jaxis.axis] == value) {
+			if(isAxisRepeat(event->jaxis.axis, value)) {
 				return true;
 			}
-
-			// store value
-			m_prevAxisValues[event->jaxis.axis] = value;
+			setAxisState(event->jaxis.axis, value);
 
 			// send
-			if(m_normalizeAxes) {
+			record.type = AXIS;
+			record.path = m_sendPaths[AXIS];
+			record.id = (int)event->jaxis.axis;
+			if(normalize) {
 				float scaled = normalizeAxisValue(value);
-				sender->send(Device::deviceAddress + m_address + "/axis",
-					"if", (int)event->jaxis.axis, scaled);
-				if(printEvents) {
+				record.isFloat = true;
+				record.fvalues[0] = scaled;
+				sendRecord(record, rule->path);
+				if(print) {
 					LOG << m_address << " " << m_name
 					    << " axis: " << (int)event->jaxis.axis
 					    << " " << scaled << std::endl;
 				}
 			}
 			else {
-				sender->send(Device::deviceAddress + m_address + "/axis",
-					"ii", (int)event->jaxis.axis, value);
-				if(printEvents) {
+				record.ivalues[0] = value;
+				sendRecord(record, rule->path);
+				if(print) {
 					LOG << m_address << " " << m_name
 					    << " axis: " << (int)event->jaxis.axis
 					    << " " << value << std::endl;
@@ -221,19 +237,22 @@ bool Joystick::handleEvent(SDL_Event *event) {
 		}
 
 		case SDL_JOYBALLMOTION: {
-			if(m_ignore && m_ignore->isIgnored(BALL, event->jball.ball)) {
+			const InputRule *rule = inputRule(BALL, event->jball.ball);
+			if(!rule || rule->ignored) {
 				break;
 			}
-			if(m_remapping) {
-				event->jball.ball = m_remapping->get(BALL, event->jball.ball);
-			}
+			event->jball.ball = rule->id;
 
-			sender->send(Device::deviceAddress + m_address + "/ball",
-				"iii", (int)event->jball.ball, (int)event->jball.xrel, (int)event->jball.yrel);
+			record.type = BALL;
+			record.path = m_sendPaths[BALL];
+			record.id = (int)event->jball.ball;
+			record.ivalues[0] = (int)event->jball.xrel;
+			record.ivalues[1] = (int)event->jball.yrel;
+			sendRecord(record, rule->path);
 
-			if(printEvents) {
+			if(print) {
 				LOG << m_address << " " << m_name
-				    << " ball: " << (int)event->jaxis.axis
+				    << " ball: " << (int)event->jball.ball
 				    << " " << (int)event->jball.xrel
 				    << " " << (int)event->jball.yrel << std::endl;
 			}
@@ -241,17 +260,21 @@ bool Joystick::handleEvent(SDL_Event *event) {
 		}
 
 		case SDL_JOYHATMOTION: {
-			if(m_ignore && m_ignore->isIgnored(HAT, event->jhat.hat)) {
+			const InputRule *rule = inputRule(HAT, event->jhat.hat);
+			if(!rule || rule->ignored) {
 				break;
 			}
-			if(m_remapping) {
-				event->jhat.hat = m_remapping->get(HAT, event->jhat.hat);
-			}
+			event->jhat.hat = rule->id;
 
-			sender->send(Device::deviceAddress + m_address + "/hat",
-				"ii", (int)event->jhat.hat, (int)event->jhat.value);
+			setHatState(event->jhat.hat, (int)event->jhat.value);
 
-			if(printEvents) {
+			record.type = HAT;
+			record.path = m_sendPaths[HAT];
+			record.id = (int)event->jhat.hat;
+			record.ivalues[0] = (int)event->jhat.value;
+			sendRecord(record, rule->path);
+
+			if(print) {
 				LOG << m_address << " " << m_name
 				    << " hat: " << (int)event->jhat.hat
 				    << " " << (int)event->jhat.value << std::endl;
@@ -295,3 +318,32 @@ void Joystick::print() {
 		shared::JoystickPrintDetails(m_joystick);
 	}
 }
+
+// PROTECTED
+
+// remapped indices have been checked against the number of inputs
+void Joystick::compileInputs() {
+	const EventType types[] = {BUTTON, AXIS, BALL, HAT};
+	const int counts[] = {
+		SDL_JoystickNumButtons(m_joystick), SDL_JoystickNumAxes(m_joystick),
+		SDL_JoystickNumBalls(m_joystick), SDL_JoystickNumHats(m_joystick)
+	};
+	for(int t = 0; t < 4; ++t) {
+		std::vector<InputRule> &rules = m_inputRules[types[t]];
+		rules.assign(MAX(counts[t], 0), InputRule());
+		for(int i = 0; i < (int)rules.size(); ++i) {
+			rules[i].ignored = (m_ignore && m_ignore->isIgnored(types[t], i));
+			rules[i].id = (m_remapping ? m_remapping->get(types[t], i) : i);
+		}
+	}
+}
+
+// paths use the remapped index as it is what's sent
+void Joystick::addInputPaths() {
+	const EventType types[] = {BUTTON, AXIS, BALL, HAT};
+	for(EventType type : types) {
+		for(auto &rule : m_inputRules[type]) {
+			rule.path = (rule.ignored ? nullptr : buildInputPath(type, nullptr, rule.id));
+		}
+	}
+}
@@ -22,6 +22,7 @@
 ==============================================================================*/
 #pragma once
 
+#include <atomic>
 #include "Device.h"
 
 class JoystickIgnore;
@@ -46,6 +47,9 @@ class Joystick : public Device {
 		/// returns	true on success
 		bool open(DeviceIndex index, DeviceSettings *settings=nullptr);
 
+		/// open haptic rumble, if supported
+		void finishOpen();
+
 		/// close the joystick
 		void close();
 
@@ -81,6 +85,28 @@ class Joystick : public Device {
 
 	protected:
 
+		/// build per-input send paths for all buttons, axes, balls, & hats
+		void addInputPaths();
+
+		/// compile button, axis, ball, & hat remappings & ignores by index
+		void compileInputs();
+
+		/// select the handleEvent() instantiation for the current flags
+		void selectHandler();
+
+		/// event handler with the flags as template parameters
+		template<bool normalize, bool print>
+		bool handle(SDL_Event *event);
+
+		/// event handler member function
+		typedef bool (Joystick::*Handler)(SDL_Event *event);
+
+		/// handle() instantiations by flag index, see selectHandler()
+		static const Handler s_handlers[4];
+
+		/// selected s_handlers index, atomic as flags may be changed from the
+		/// OSC receiver thread while handling events
+		std::atomic<int> m_handlerIndex{0};
 		SDL_Joystick *m_joystick = nullptr; ///< SDL joystick handle
 		SDL_Haptic *m_haptic = nullptr; ///< haptic handle, if supported
 };
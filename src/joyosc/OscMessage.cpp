@@ -0,0 +1,98 @@
+/*==============================================================================
+
+	OscMessage.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "OscMessage.h"
+
+#include <cstring>
+
+void OscMessage::clear() {
+	m_types[1] = '\0';
+	m_numArgs = 0;
+	m_argsSize = 0;
+	m_valid = true;
+}
+
+bool OscMessage::addInt32(int32_t value) {
+	char *dest = reserve('i', 4);
+	if(!dest) {return false;}
+	writeInt32(dest, (uint32_t)value);
+	return true;
+}
+
+bool OscMessage::addInt64(int64_t value) {
+	char *dest = reserve('h', 8);
+	if(!dest) {return false;}
+	writeInt64(dest, (uint64_t)value);
+	return true;
+}
+
+bool OscMessage::addFloat(float value) {
+	char *dest = reserve('f', 4);
+	if(!dest) {return false;}
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	writeInt32(dest, bits);
+	return true;
+}
+
+bool OscMessage::addString(const char *value) {
+	if(!value) {value = "";}
+	size_t length = strlen(value);
+	size_t padded = paddedSize(length);
+	char *dest = reserve('s', padded);
+	if(!dest) {return false;}
+	memcpy(dest, value, length);
+	memset(dest + length, 0, padded - length);
+	return true;
+}
+
+size_t OscMessage::size() const {
+	return paddedSize(strlen(m_path)) + paddedSize(m_numArgs + 1) + m_argsSize;
+}
+
+size_t OscMessage::write(char *dest, size_t available) const {
+	if(!m_valid) {return 0;}
+	size_t pathLength = strlen(m_path);
+	size_t pathSize = paddedSize(pathLength);
+	size_t typesSize = paddedSize(m_numArgs + 1);
+	size_t total = pathSize + typesSize + m_argsSize;
+	if(total > available) {return 0;}
+	memset(dest, 0, pathSize + typesSize);
+	memcpy(dest, m_path, pathLength);
+	memcpy(dest + pathSize, m_types, m_numArgs + 1);
+	memcpy(dest + pathSize + typesSize, m_args, m_argsSize);
+	return total;
+}
+
+// PROTECTED
+
+char* OscMessage::reserve(char type, size_t size) {
+	if(!m_valid || m_numArgs >= MAX_ARGS || m_argsSize + size > MAX_ARG_BYTES) {
+		m_valid = false;
+		return nullptr;
+	}
+	m_types[++m_numArgs] = type;
+	m_types[m_numArgs + 1] = '\0';
+	char *dest = m_args + m_argsSize;
+	m_argsSize += size;
+	return dest;
+}
@@ -0,0 +1,144 @@
+/*==============================================================================
+
+	OscMessage.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// \class OscMessage
+/// \brief fixed-size OSC message encoder which never allocates
+///
+/// Arguments are encoded big endian into an internal buffer as they are
+/// added, write() then serializes the path, typetag, & arguments into a
+/// packet buffer. Adding too many arguments marks the message as invalid.
+///
+/// note: the path is not copied & must stay valid while the message is used
+class OscMessage {
+
+	public:
+
+		/// max number of arguments
+		static const size_t MAX_ARGS = 254;
+
+		/// max size of the encoded arguments in bytes
+		static const size_t MAX_ARG_BYTES = 2048;
+
+		/// create with send path
+		OscMessage(const char *path="") : m_path(path) {}
+
+		/// set send path
+		inline void setPath(const char *path) {m_path = path;}
+
+		/// get send path
+		inline const char* getPath() const {return m_path;}
+
+		/// get typetag ie. ",si"
+		inline const char* getTypes() const {return m_types;}
+
+		/// remove all arguments
+		void clear();
+
+		/// add arguments, returns false & marks the message invalid if full
+		bool addInt32(int32_t value);
+		bool addInt64(int64_t value);
+		bool addFloat(float value);
+		bool addString(const char *value);
+
+		/// add arguments by typetag, ie. add("sif", "foo", 1, 2.0f),
+		/// returns false & marks the message invalid on a type mismatch
+		template <typename... Args>
+		bool add(const char *types, Args... args) {
+			return addArgs(types ? types : "", args...);
+		}
+
+		/// returns false if arguments were lost or mismatched
+		inline bool isValid() const {return m_valid;}
+
+		/// returns the encoded size in bytes
+		size_t size() const;
+
+		/// write encoded message to dest, returns the number of bytes written
+		/// or 0 if the message is invalid or does not fit
+		size_t write(char *dest, size_t available) const;
+
+	/// \section static utils
+
+		/// returns the size of an OSC string including padding
+		static inline size_t paddedSize(size_t length) {
+			return (length + 4) & ~(size_t)3;
+		}
+
+		/// write big endian 32 or 64 bit values
+		static inline void writeInt32(char *dest, uint32_t value) {
+			dest[0] = (char)(value >> 24);
+			dest[1] = (char)(value >> 16);
+			dest[2] = (char)(value >> 8);
+			dest[3] = (char)value;
+		}
+		static inline void writeInt64(char *dest, uint64_t value) {
+			writeInt32(dest, (uint32_t)(value >> 32));
+			writeInt32(dest + 4, (uint32_t)value);
+		}
+
+	protected:
+
+		/// typetag argument matching, ends when types & arguments are used up
+		bool addArgs(const char *types) {
+			if(*types != '\0') {m_valid = false;}
+			return m_valid;
+		}
+		template <typename... Args>
+		bool addArgs(const char *types, int32_t value, Args... args) {
+			if(*types != 'i') {m_valid = false; return false;}
+			addInt32(value);
+			return addArgs(types + 1, args...);
+		}
+		template <typename... Args>
+		bool addArgs(const char *types, int64_t value, Args... args) {
+			if(*types != 'h') {m_valid = false; return false;}
+			addInt64(value);
+			return addArgs(types + 1, args...);
+		}
+		template <typename... Args>
+		bool addArgs(const char *types, float value, Args... args) {
+			if(*types != 'f') {m_valid = false; return false;}
+			addFloat(value);
+			return addArgs(types + 1, args...);
+		}
+		template <typename... Args>
+		bool addArgs(const char *types, const char *value, Args... args) {
+			if(*types != 's') {m_valid = false; return false;}
+			addString(value);
+			return addArgs(types + 1, args...);
+		}
+
+		/// reserve space for a new argument, returns nullptr if full
+		char* reserve(char type, size_t size);
+
+		const char *m_path = ""; ///< send path
+		char m_types[MAX_ARGS + 2] = {','}; ///< typetag, null terminated
+		size_t m_numArgs = 0; ///< number of arguments
+		char m_args[MAX_ARG_BYTES]; ///< encoded arguments
+		size_t m_argsSize = 0; ///< encoded arguments size in bytes
+		bool m_valid = true; ///< false if an argument was lost
+};
@@ -0,0 +1,107 @@
+/*==============================================================================
+
+	RingBuffer.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+/// \class RingBuffer
+/// \brief lock-free single-producer/single-consumer ring buffer
+///
+/// push() must only be called from one thread and pop() from one other thread.
+/// Neither blocks: push() fails when the ring is full and counts an overflow,
+/// pop() fails when the ring is empty.
+template <typename T>
+class RingBuffer {
+
+	public:
+
+		/// create ring with capacity, rounded up to the next power of 2
+		RingBuffer(size_t capacity) {
+			size_t size = 2;
+			while(size < capacity) {size <<= 1;}
+			m_buffer.resize(size);
+			m_mask = size - 1;
+		}
+
+		/// push a value, returns false & counts an overflow if full
+		/// producer thread only
+		bool push(const T &value) {
+			size_t head = m_head.load(std::memory_order_relaxed);
+			if(head - m_tail.load(std::memory_order_acquire) > m_mask) {
+				m_overflows.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			m_buffer[head & m_mask] = value;
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// pop a value, returns false if empty
+		/// consumer thread only
+		bool pop(T &value) {
+			size_t tail = m_tail.load(std::memory_order_relaxed);
+			if(tail == m_head.load(std::memory_order_acquire)) {
+				return false;
+			}
+			value = m_buffer[tail & m_mask];
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// returns true if there is nothing to pop
+		inline bool empty() const {
+			return m_head.load(std::memory_order_acquire) ==
+			       m_tail.load(std::memory_order_acquire);
+		}
+
+		/// current number of values in the ring
+		inline size_t depth() const {
+			return m_head.load(std::memory_order_acquire) -
+			       m_tail.load(std::memory_order_acquire);
+		}
+
+		/// max number of values in the ring
+		inline size_t capacity() const {return m_mask + 1;}
+
+		/// number of values dropped as the ring was full
+		inline uint64_t overflows() const {
+			return m_overflows.load(std::memory_order_relaxed);
+		}
+
+	protected:
+
+		std::vector<T> m_buffer; ///< value storage
+		size_t m_mask = 0; ///< capacity - 1, for wrapping indices
+
+		// head & tail are padded onto separate cache lines to avoid false
+		// sharing, padding instead of alignas as C++11 new ignores over alignment,
+		// both only ever increase & are wrapped when indexing
+		char m_pad0[64];
+		std::atomic<size_t> m_head{0}; ///< next write, producer
+		char m_pad1[64];
+		std::atomic<size_t> m_tail{0}; ///< next read, consumer
+		char m_pad2[64];
+		std::atomic<uint64_t> m_overflows{0}; ///< num dropped values, producer
+};
@@ -0,0 +1,104 @@
+/*==============================================================================
+
+	SendQueue.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "SendQueue.h"
+
+// continuous updates never grow the queue, so the input table never exceeds
+// the capacity
+SendQueue::SendQueue(size_t capacity) : m_capacity(capacity) {
+	m_free.resize(capacity);
+	m_inputs.reserve(capacity);
+}
+
+SendQueue::Entry* SendQueue::push(const Key *key) {
+	if(m_capacity == 0) {
+		dropped++;
+		return nullptr;
+	}
+	if(key) {
+		for(auto &input : m_inputs) {
+			if(input.key == *key) {
+				// the stale update is replaced & moves to the back so the input
+				// keeps its order with the messages around it
+				m_entries.splice(m_entries.end(), m_entries, input.entry);
+				overwritten++;
+				return &m_entries.back();
+			}
+		}
+	}
+	if(m_entries.size() >= m_capacity && !drop()) {
+		if(key) { // the update is superseded by the next one anyway
+			dropped++;
+			return nullptr;
+		}
+		grown++;
+	}
+	if(m_free.empty()) {
+		m_free.emplace_back();
+	}
+	m_entries.splice(m_entries.end(), m_free, m_free.begin());
+	Entry &entry = m_entries.back();
+	entry.continuous = (key != nullptr);
+	if(key) {
+		entry.key = *key;
+		m_inputs.push_back({*key, std::prev(m_entries.end())});
+	}
+	return &entry;
+}
+
+void SendQueue::pop() {
+	if(m_entries.empty()) {return;}
+	release(m_entries.begin());
+}
+
+void SendQueue::clear() {
+	while(!m_entries.empty()) {
+		release(m_entries.begin());
+	}
+}
+
+// PROTECTED
+
+// continuous updates are superseded by the next one anyway, so losing one
+// costs the least, other messages are never dropped
+bool SendQueue::drop() {
+	if(m_inputs.empty()) {return false;}
+	auto it = m_entries.begin();
+	while(!it->continuous) {++it;}
+	release(it);
+	dropped++;
+	return true;
+}
+
+void SendQueue::release(std::list<Entry>::iterator entry) {
+	if(entry->continuous) {
+		for(size_t i = 0; i < m_inputs.size(); ++i) {
+			if(m_inputs[i].entry == entry) {
+				m_inputs[i] = m_inputs.back();
+				m_inputs.pop_back();
+				break;
+			}
+		}
+		entry->continuous = false;
+	}
+	m_free.splice(m_free.end(), m_entries, entry);
+}
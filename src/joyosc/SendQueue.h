@@ -0,0 +1,125 @@
+/*==============================================================================
+
+	SendQueue.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include <list>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <lo/lo.h>
+
+/// \class SendQueue
+/// \brief bounded queue of encoded messages waiting for a blocked destination
+///
+/// When a destination socket would block, ie. the receiver has stalled or the
+/// kernel send buffer is full, messages are queued here instead & sent in
+/// order once the socket takes data again.
+///
+/// Continuous input updates are conflated: a newer update for the same input
+/// replaces the queued one & moves to the back, counted as overwritten. When
+/// full, the oldest continuous update is dropped, or the new one if nothing
+/// else can be dropped. Other messages, ie. button & hat changes,
+/// notifications, & replies, are never dropped: if the queue holds nothing
+/// else, it grows beyond its capacity & counts them as grown. Continuous
+/// updates never grow the queue, so the added latency stays bounded unless
+/// the receiver never takes the edges.
+///
+/// Entries for the capacity & the continuous input table are preallocated &
+/// entry buffers are reused, so pushes within the capacity do not allocate
+/// once the entries have been filled. Not thread safe, the Sender serializes
+/// access.
+class SendQueue {
+
+	public:
+
+		/// continuous input key: send path & input id or name, the path pointer
+		/// identifies the device & type as paths are interned
+		typedef std::pair<const char *, intptr_t> Key;
+
+		/// queued message
+		struct Entry {
+			std::string path; ///< message path
+			std::vector<char> data; ///< encoded message
+			bool bundled = false; ///< send in a bundle?
+			bool frame = false; ///< binary frame record? see joyosc_frame.h
+			size_t mtu = 0; ///< max bundle size in bytes
+			lo_timetag timetag = {0, 0}; ///< bundle timetag
+			Key key; ///< input key, if continuous
+			bool continuous = false; ///< continuous input update?
+		};
+
+		/// create with max number of queued messages, 0 drops everything
+		SendQueue(size_t capacity=256);
+
+		/// returns an entry to fill with a new message, a continuous update if
+		/// key is set which reuses the queued entry for the same input, drops
+		/// a continuous update if full, returns nullptr if the capacity is 0 or
+		/// if the new continuous update was dropped
+		Entry* push(const Key *key=nullptr);
+
+		/// returns the oldest entry or nullptr if empty
+		inline Entry* front() {return (m_entries.empty() ? nullptr : &m_entries.front());}
+
+		/// remove the oldest entry
+		void pop();
+
+		/// remove all entries
+		void clear();
+
+		/// returns true if nothing is queued
+		inline bool empty() const {return m_entries.empty();}
+
+		/// current number of queued messages
+		inline size_t size() const {return m_entries.size();}
+
+		/// max number of queued messages
+		inline size_t capacity() const {return m_capacity;}
+
+	/// \section counters
+
+		uint64_t dropped = 0; ///< total messages dropped as the queue was full
+		uint64_t overwritten = 0; ///< total continuous updates replaced by newer ones
+		uint64_t grown = 0; ///< total messages queued beyond the capacity
+
+	protected:
+
+		/// queued continuous update
+		struct Input {
+			Key key; ///< input key
+			std::list<Entry>::iterator entry; ///< queued entry
+		};
+
+		/// drop the oldest continuous update, returns false if there is none
+		bool drop();
+
+		/// remove an entry & keep it for reuse
+		void release(std::list<Entry>::iterator entry);
+
+		size_t m_capacity = 0; ///< max number of queued messages
+		std::list<Entry> m_entries; ///< queued messages, oldest first
+		std::list<Entry> m_free; ///< released entries for reuse
+
+		/// queued continuous updates, unordered, at most one per input so
+		/// this stays small & is searched linearly
+		std::vector<Input> m_inputs;
+};
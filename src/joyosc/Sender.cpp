@@ -0,0 +1,472 @@
+/*==============================================================================
+
+	Sender.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "Sender.h"
+
+#include <climits>
+#include "../shared.h"
+
+Sender::~Sender() {
+	stop();
+	for(auto destination : m_destinations) {
+		delete destination;
+	}
+	m_destinations.clear();
+}
+
+bool Sender::addDestination(const DestinationSettings &settings) {
+	Destination *destination = new Destination(settings);
+	if(!destination->open()) {
+		LOG_WARN << "Sender: could not open destination "
+		         << destination->toString() << std::endl;
+		delete destination;
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	m_destinations.push_back(destination);
+	m_matches.resize(m_destinations.size(), 0);
+	return true;
+}
+
+void Sender::start() {
+	m_active = true;
+	if(!threaded || m_running) {return;}
+	if(!m_queue) {
+		m_queue = new RingBuffer<EventRecord>(queueSize);
+	}
+	m_running = true;
+	m_thread = std::thread(&Sender::process, this);
+	LOG_VERBOSE << "Sender: started thread with queue size "
+	            << m_queue->capacity() << std::endl;
+}
+
+void Sender::stop() {
+	if(m_running) {
+		m_running = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_condition.notify_one();
+		}
+		if(m_thread.joinable()) {
+			m_thread.join();
+		}
+		if(Log::logLevel < Log::LEVEL_NORMAL) {
+			printQueue();
+		}
+		delete m_queue;
+		m_queue = nullptr;
+	}
+	if(m_active) {
+		// send anything left over, messages are sent immediately from now on
+		m_active = false;
+		flushOutput();
+		if(Log::logLevel < Log::LEVEL_NORMAL) {
+			printStats();
+		}
+	}
+}
+
+void Sender::send(const EventRecord &record) {
+	if(!m_running) {
+		sendRecord(record);
+		return;
+	}
+	push(record);
+	m_pushed = true;
+}
+
+void Sender::flush() {
+	if(!m_active) {return;}
+	if(m_running) {
+		// let the sender thread flush after the records pushed so far
+		if(m_pushed || m_outputPending || usUntilHeld() == 0) {
+			EventRecord marker; // nullptr path
+			if(push(marker)) {
+				m_pushed = false;
+			}
+		}
+		return;
+	}
+	flushOutput();
+}
+
+unsigned int Sender::usUntilHeld() {
+	uint32_t due = m_heldDue;
+	if(due == 0) {return UINT_MAX;}
+	int32_t ms = (int32_t)(due - SDL_GetTicks());
+	return (ms > 0 ? (unsigned int)ms * 1000 : 0);
+}
+
+bool Sender::setFlow(const std::string &name, unsigned int rate) {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	for(auto destination : m_destinations) {
+		const std::string &destinationName = destination->getSettings().name;
+		if(destinationName == name || (destinationName == "" && name == "main")) {
+			destination->setFlow(rate);
+			updateHeldDue();
+			LOG_VERBOSE << "Sender: " << destination->toString() << " flow "
+			            << (rate > 0 ? std::to_string(rate) + " msgs/s" : "unlimited")
+			            << std::endl;
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t Sender::queueDepth() {
+	return (m_queue ? m_queue->depth() : 0);
+}
+
+uint64_t Sender::queueOverflows() {
+	return (m_queue ? m_queue->overflows() : 0);
+}
+
+uint64_t Sender::queueDropped() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	uint64_t count = 0;
+	for(auto destination : m_destinations) {
+		count += destination->getQueue().dropped;
+	}
+	return count;
+}
+
+uint64_t Sender::queueOverwritten() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	uint64_t count = 0;
+	for(auto destination : m_destinations) {
+		count += destination->getQueue().overwritten;
+	}
+	return count;
+}
+
+uint64_t Sender::queueGrown() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	uint64_t count = 0;
+	for(auto destination : m_destinations) {
+		count += destination->getQueue().grown;
+	}
+	return count;
+}
+
+void Sender::printQueue() {
+	LOG << "send queue depth: " << queueDepth()
+	    << " overflows: " << queueOverflows() << std::endl;
+}
+
+uint64_t Sender::messagesSent() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	uint64_t count = 0;
+	for(auto destination : m_destinations) {
+		count += destination->messagesSent();
+	}
+	return count;
+}
+
+uint64_t Sender::packetsSent() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	uint64_t count = 0;
+	for(auto destination : m_destinations) {
+		count += destination->packetsSent();
+	}
+	return count;
+}
+
+uint64_t Sender::sendCalls() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	uint64_t count = 0;
+	for(auto destination : m_destinations) {
+		count += destination->sendCalls();
+	}
+	return count;
+}
+
+void Sender::printStats() {
+	LOG << "sent messages: " << messagesSent()
+	    << " packets: " << packetsSent()
+	    << " send calls: " << sendCalls() << std::endl;
+	uint64_t dropped = queueDropped(), overwritten = queueOverwritten(), grown = queueGrown();
+	if(dropped > 0 || overwritten > 0 || grown > 0) {
+		LOG << "blocked sends dropped: " << dropped
+		    << " overwritten: " << overwritten
+		    << " grown: " << grown << std::endl;
+	}
+	if(m_destinations.size() > 1) {
+		std::lock_guard<std::mutex> lock(m_outputMutex);
+		for(auto destination : m_destinations) {
+			LOG << "  " << destination->toString()
+			    << " messages: " << destination->messagesSent()
+			    << " packets: " << destination->packetsSent() << std::endl;
+		}
+	}
+}
+
+// PROTECTED
+
+// filters run before encoding, so messages which no destination wants are
+// never serialized
+void Sender::sendRecord(const EventRecord &record) {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	bool matched = false;
+	for(size_t i = 0; i < m_destinations.size(); ++i) {
+		m_matches[i] = m_destinations[i]->accepts(record);
+		matched = matched || m_matches[i];
+	}
+	updateHeldDue();
+	if(!matched) {return;}
+	writeRecord(record);
+}
+
+// input name or id, unless the input is part of the path
+static inline void addInput(const EventRecord &record, OscMessage &message) {
+	if(record.inputPath) {return;}
+	if(record.name) {message.addString(record.name);}
+	else {message.addInt32(record.id);}
+}
+
+// paths & names are prebuilt & messages are encoded on the stack,
+// so nothing is allocated here
+void Sender::encodeRecord(const EventRecord &record, OscMessage &message) {
+	message.setPath(record.path);
+	addInput(record, message);
+	switch(record.type) {
+		case BUTTON: case HAT:
+			message.addInt32(record.ivalues[0]);
+			break;
+		case AXIS:
+			if(record.isFloat) {message.addFloat(record.fvalues[0]);}
+			else {message.addInt32(record.ivalues[0]);}
+			break;
+		case BALL:
+			message.addInt32(record.ivalues[0]);
+			message.addInt32(record.ivalues[1]);
+			break;
+		case TOUCHPAD:
+			message.addInt32(record.ivalues[0]);
+			message.addInt32(record.ivalues[1]);
+			message.addFloat(record.fvalues[0]);
+			message.addFloat(record.fvalues[1]);
+			message.addFloat(record.fvalues[2]);
+			break;
+		case SENSOR:
+			message.addFloat(record.fvalues[0]);
+			message.addFloat(record.fvalues[1]);
+			message.addFloat(record.fvalues[2]);
+			break;
+	}
+	if(record.sequence) {
+		// last so consumers which read fixed positions are unaffected
+		message.addInt32((int32_t)record.sequence);
+	}
+}
+
+void Sender::writeRecord(const EventRecord &record) {
+	if(!matchesOsc()) {
+		// binary frame destinations encode the record themselves
+		OscPacket packet(record.path, nullptr, 0);
+		packet.record = &record;
+		writePacket(packet, false, m_timetag);
+		return;
+	}
+	OscMessage message;
+	encodeRecord(record, message);
+	if(timetags) {
+		lo_timetag timetag = eventTimetag(record);
+		write(message, true, &timetag, &record);
+	}
+	else {
+		write(message, isBundling(), nullptr, &record);
+	}
+}
+
+// SDL timestamps are ms since SDL init, anchored to the wall clock once per
+// flush so all records in a flush use the same mapping, the precision is
+// limited to ms unless the record has us
+lo_timetag Sender::eventTimetag(const EventRecord &record) {
+	if(!m_clockSet) {
+		m_clockTicks = SDL_GetTicks();
+		lo_timetag_now(&m_clockTime);
+		m_clockSet = true;
+	}
+
+	// age in us, unsigned tick differences handle wraparound, events are
+	// never from the future & anything older than a minute is bogus
+	int64_t age = (int64_t)(int32_t)(m_clockTicks - record.timestamp) * 1000 -
+	              (int64_t)record.timestampUS;
+	age = MAX(MIN(age, (int64_t)60000000), (int64_t)0);
+
+	// NTP time is 32.32 fixed point seconds
+	uint64_t time = ((uint64_t)m_clockTime.sec << 32) | m_clockTime.frac;
+	time -= ((uint64_t)age << 32) / 1000000;
+	lo_timetag timetag = {(uint32_t)(time >> 32), (uint32_t)time};
+	return timetag;
+}
+
+void Sender::output(const OscMessage &message, bool bundled, Route route,
+                    const char *address) {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	bool matched = false;
+	for(size_t i = 0; i < m_destinations.size(); ++i) {
+		const DestinationSettings &settings = m_destinations[i]->getSettings();
+		switch(route) {
+			case ROUTE_NOTIFICATION:
+				m_matches[i] = settings.notifications;
+				break;
+			case ROUTE_REPLY:
+				m_matches[i] = settings.replies;
+				break;
+			case ROUTE_STATE:
+				m_matches[i] = m_destinations[i]->acceptsState(address);
+				break;
+			default: // ROUTE_ALL
+				m_matches[i] = true;
+				break;
+		}
+		matched = matched || m_matches[i];
+	}
+	if(matched) {
+		write(message, bundled);
+	}
+}
+
+// encode once, then every matching destination copies or sends the same bytes
+void Sender::write(const OscMessage &message, bool bundled, const lo_timetag *timetag,
+                   const EventRecord *record) {
+	char buffer[4096];
+	size_t size = message.write(buffer, sizeof(buffer));
+	if(size == 0) {
+		LOG_DEBUG << "Sender: dropped " << message.getPath()
+		          << ": invalid or too large" << std::endl;
+		return;
+	}
+	if(!timetag) {
+		if(bundled && !m_timetagSet) {
+			// all bundles until the next flush share the same time
+			lo_timetag_now(&m_timetag);
+			m_timetagSet = true;
+		}
+		timetag = &m_timetag; // unused if not bundled
+	}
+	OscPacket packet(message.getPath(), buffer, size);
+	packet.record = record;
+	writePacket(packet, bundled, *timetag);
+}
+
+void Sender::writePacket(OscPacket &packet, bool bundled, lo_timetag timetag) {
+	m_outputPending = true;
+	for(size_t i = 0; i < m_destinations.size(); ++i) {
+		if(m_matches[i]) {
+			m_destinations[i]->output(packet, bundled, bundleMTU, timetag);
+		}
+	}
+}
+
+bool Sender::matchesOsc() {
+	for(size_t i = 0; i < m_destinations.size(); ++i) {
+		if(m_matches[i] && !m_destinations[i]->isFrames()) {return true;}
+	}
+	return false;
+}
+
+void Sender::sendHeld() {
+	uint32_t now = SDL_GetTicks();
+	for(size_t i = 0; i < m_destinations.size(); ++i) {
+		m_due.clear();
+		m_destinations[i]->takeHeld(now, m_due);
+		if(m_due.empty()) {continue;}
+		for(size_t j = 0; j < m_destinations.size(); ++j) {
+			m_matches[j] = (i == j);
+		}
+		for(auto &record : m_due) {
+			writeRecord(record);
+		}
+	}
+	updateHeldDue();
+}
+
+void Sender::updateHeldDue() {
+	uint32_t due = 0;
+	for(auto destination : m_destinations) {
+		due = Destination::earlier(due, destination->heldDue());
+	}
+	m_heldDue = due;
+}
+
+void Sender::flushOutput() {
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	if(m_heldDue != 0) {
+		sendHeld();
+	}
+	bool pending = false;
+	m_timetagSet = false;
+	m_clockSet = false;
+	for(auto destination : m_destinations) {
+		destination->flush();
+		pending = pending || destination->isPending();
+	}
+
+	// keep flushing each iteration until the output has been sent
+	m_outputPending = pending;
+}
+
+bool Sender::push(const EventRecord &record) {
+	bool pushed = m_queue->push(record);
+
+	// only take the lock if the sender thread might be waiting, the fence
+	// orders the push before reading the flag, see process()
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(m_waiting.load()) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_condition.notify_one();
+	}
+	return pushed;
+}
+
+void Sender::process() {
+	EventRecord record;
+	while(m_running) {
+		while(m_queue->pop(record)) {
+			if(record.path) {sendRecord(record);}
+			else {flushOutput();}
+		}
+
+		// send batched datagrams before waiting, bundles wait for a flush marker
+		if(!isBundling() && m_outputPending) {
+			flushOutput();
+		}
+
+		// wait for more records, the producer only notifies when the waiting
+		// flag is set so set it before checking the queue one last time,
+		// the timeout is a fallback in case a wakeup is missed
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_waiting = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		m_condition.wait_for(lock, std::chrono::milliseconds(100), [this] {
+			return !m_running || !m_queue->empty();
+		});
+		m_waiting = false;
+	}
+
+	// send whatever is left
+	while(m_queue->pop(record)) {
+		if(record.path) {sendRecord(record);}
+	}
+}
@@ -0,0 +1,301 @@
+/*==============================================================================
+
+	Sender.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "Common.h"
+#include "Event.h"
+#include "RingBuffer.h"
+#include "OscMessage.h"
+#include "Destination.h"
+
+/// \class Sender
+/// \brief serializes device event records & sends them as OSC messages
+///
+/// By default, events are sent immediately on the calling thread. When
+/// threaded, the event loop only pushes records into a lock-free ring and a
+/// dedicated thread serializes and sends them, so event handling never blocks
+/// on the network. Notifications and query replies are always sent
+/// immediately.
+///
+/// When bundling, all event messages between two flush() calls are collected
+/// into timetagged bundles split by MTU, ie. one datagram per event loop
+/// iteration. Notifications and query replies can opt in separately.
+///
+/// Messages are encoded with OscMessage without allocating. If sendmmsg() is
+/// available, event datagrams are batched & sent with one system call per
+/// flush(), otherwise liblo is used to send.
+///
+/// Messages are sent to one or more destinations, each with its own event
+/// filters. A message is encoded once & the same buffer is sent to every
+/// matching destination. Rate limited records held by a destination are sent
+/// on flush() once due.
+///
+/// Destinations may send event records as binary frames instead of OSC
+/// messages, see joyosc_frame.h. Records are only encoded as OSC if a
+/// matching destination sends OSC.
+///
+/// Batched & TCP sends never block: while a destination socket would block,
+/// its messages wait in a bounded queue which drops or overwrites stale
+/// continuous updates first, see SendQueue.
+class Sender {
+
+	public:
+
+		Sender() {}
+		virtual ~Sender();
+
+		/// add a destination to send to, call before start()
+		/// returns true on success
+		bool addDestination(const DestinationSettings &settings);
+
+		/// get the number of destinations
+		inline size_t numDestinations() {return m_destinations.size();}
+
+		/// start sending, starts the sender thread if threaded
+		void start();
+
+		/// stop sending, sends any queued records & stops the sender thread
+		void stop();
+
+		/// send a device event record
+		/// note: call from the event loop thread only
+		void send(const EventRecord &record);
+
+		/// send an OSC message immediately with optional typetag & arguments,
+		/// returns false if the arguments do not match the typetag
+		template <typename... Args>
+		bool send(const std::string &path, const char *types="", Args... args) {
+			return sendMessage(path, false, ROUTE_ALL, types, args...);
+		}
+
+		/// send a device state snapshot OSC message to destinations which
+		/// accept state for the interned device address, bundled if bundling
+		void send(const OscMessage &message, const char *address) {
+			output(message, isBundling(), ROUTE_STATE, address);
+		}
+
+		/// send a notification OSC message, bundled if bundleNotifications
+		template <typename... Args>
+		bool sendNotification(const std::string &path, const char *types="", Args... args) {
+			return sendMessage(path, bundleNotifications, ROUTE_NOTIFICATION, types, args...);
+		}
+
+		/// send a query reply OSC message, bundled if bundleReplies
+		template <typename... Args>
+		bool sendReply(const std::string &path, const char *types="", Args... args) {
+			return sendMessage(path, bundleReplies, ROUTE_REPLY, types, args...);
+		}
+
+		/// send a query reply OSC message with a variable number of arguments,
+		/// bundled if bundleReplies
+		void sendReply(const OscMessage &message) {
+			output(message, bundleReplies, ROUTE_REPLY, nullptr);
+		}
+
+		/// send due held records & the current bundle or batched datagrams,
+		/// if any
+		/// note: call from the event loop thread only, once per iteration
+		void flush();
+
+		/// returns micro seconds until a rate limited record is due,
+		/// 0 if due now or UINT_MAX if none are held
+		unsigned int usUntilHeld();
+
+		/// set the consumer flow limit for a destination by name in continuous
+		/// messages per second, "" or "main" for the main destination, 0 for
+		/// unlimited, returns false if there is no such destination
+		/// note: thread safe
+		bool setFlow(const std::string &name, unsigned int rate);
+
+		/// number of records currently waiting in the queue
+		size_t queueDepth();
+
+		/// number of records dropped as the queue was full
+		uint64_t queueOverflows();
+
+		/// number of messages dropped while destinations would block
+		uint64_t queueDropped();
+
+		/// number of continuous updates overwritten while destinations would block
+		uint64_t queueOverwritten();
+
+		/// number of messages queued beyond the capacity while destinations
+		/// would block, as only continuous updates are dropped
+		uint64_t queueGrown();
+
+		/// print queue counters
+		void printQueue();
+
+		/// number of messages sent
+		uint64_t messagesSent();
+
+		/// number of packets sent, ie. datagrams, bundles, or TCP frames
+		uint64_t packetsSent();
+
+		/// number of send system calls
+		uint64_t sendCalls();
+
+		/// print send counters
+		void printStats();
+
+	/// \section settings
+
+		/// send events from a dedicated thread?
+		bool threaded = false;
+
+		/// max number of queued records when threaded
+		unsigned int queueSize = 1024;
+
+		/// collect messages into bundles until flush()?
+		bool bundle = false;
+
+		/// max bundle size in bytes, larger bundles are split
+		unsigned int bundleMTU = 1472;
+
+		/// bundle notifications with events?
+		bool bundleNotifications = false;
+
+		/// bundle query replies with events?
+		bool bundleReplies = false;
+
+		/// send event records in bundles timetagged with their SDL event
+		/// timestamps? consecutive records with the same timetag share a bundle
+		bool timetags = false;
+
+		/// called when a notification or reply is bundled, ie. to wake the
+		/// event loop so it flushes soon, may be called from any thread
+		std::function<void()> bundleCallback;
+
+	protected:
+
+		/// message destination selection
+		enum Route {
+			ROUTE_ALL,          ///< all destinations
+			ROUTE_NOTIFICATION, ///< destinations which accept notifications
+			ROUTE_REPLY,        ///< destinations which accept query replies
+			ROUTE_STATE         ///< destinations which accept device state
+		};
+
+		/// filter, serialize a record to OSC, & send
+		void sendRecord(const EventRecord &record);
+
+		/// serialize a record into an OSC message
+		static void encodeRecord(const EventRecord &record, OscMessage &message);
+
+		/// encode & write a record, bundled with its event timetag if sending
+		/// timetags, lock m_outputMutex before calling
+		void writeRecord(const EventRecord &record);
+
+		/// returns the NTP timetag for a record's SDL event timestamp,
+		/// lock m_outputMutex before calling
+		lo_timetag eventTimetag(const EventRecord &record);
+
+		/// send or bundle a message to the routed destinations, thread safe,
+		/// address is the interned device address for ROUTE_STATE
+		/// note: sent messages may wait for flushOutput() if batching
+		void output(const OscMessage &message, bool bundled, Route route,
+		            const char *address=nullptr);
+
+		/// encode & send or bundle a message to the destinations set in
+		/// m_matches, bundles use timetag if set, otherwise the current time,
+		/// record is the event record the message was encoded from, if any,
+		/// lock m_outputMutex before calling
+		void write(const OscMessage &message, bool bundled, const lo_timetag *timetag=nullptr,
+		           const EventRecord *record=nullptr);
+
+		/// send or bundle an encoded packet to the destinations set in
+		/// m_matches, lock m_outputMutex before calling
+		void writePacket(OscPacket &packet, bool bundled, lo_timetag timetag);
+
+		/// returns true if any destination set in m_matches sends OSC
+		/// messages for records, ie. not binary frames,
+		/// lock m_outputMutex before calling
+		bool matchesOsc();
+
+		/// send or bundle a notification or reply message
+		template <typename... Args>
+		bool sendMessage(const std::string &path, bool bundled, Route route,
+		                 const char *types, Args... args) {
+			OscMessage message(path.c_str());
+			if(!message.add(types, args...)) {
+				LOG_WARN << "Sender: dropped " << path << ": invalid arguments" << std::endl;
+				return false;
+			}
+			if(bundled && isBundling()) {
+				output(message, true, route);
+				if(bundleCallback) {bundleCallback();}
+			}
+			else {
+				output(message, false, route);
+				flushOutput();
+			}
+			return true;
+		}
+
+		/// are messages currently being bundled?
+		inline bool isBundling() {return bundle && m_active;}
+
+		/// send held records which are due, lock m_outputMutex before calling
+		void sendHeld();
+
+		/// update the earliest held record due time,
+		/// lock m_outputMutex before calling
+		void updateHeldDue();
+
+		/// send due held records & the current bundle or batched datagrams,
+		/// thread safe
+		void flushOutput();
+
+		/// push record into the queue & wake the sender thread if waiting,
+		/// returns false if the queue is full
+		bool push(const EventRecord &record);
+
+		/// sender thread loop
+		void process();
+
+		std::vector<Destination *> m_destinations; ///< destinations to send to
+		std::vector<char> m_matches; ///< destinations to write() to
+		std::vector<EventRecord> m_due; ///< due held records, reused
+		std::atomic<uint32_t> m_heldDue{0}; ///< earliest held record due time, 0 if none
+		std::atomic<bool> m_active{false}; ///< started & not stopped?
+		std::mutex m_outputMutex; ///< destination mutex
+
+		std::atomic<bool> m_outputPending{false}; ///< output since last flush?
+		lo_timetag m_timetag = {0, 0}; ///< current bundle timetag
+		bool m_timetagSet = false; ///< has the timetag been set since last flush?
+		uint32_t m_clockTicks = 0; ///< SDL ticks at m_clockTime
+		lo_timetag m_clockTime = {0, 0}; ///< event timetag clock anchor
+		bool m_clockSet = false; ///< has the clock been anchored since last flush?
+		bool m_pushed = false; ///< records pushed since last flush? event loop only
+
+		RingBuffer<EventRecord> *m_queue = nullptr; ///< record queue, if threaded
+		std::thread m_thread; ///< sender thread, if threaded
+		std::atomic<bool> m_running{false}; ///< is the sender thread running?
+		std::atomic<bool> m_waiting{false}; ///< is the sender thread waiting?
+		std::mutex m_mutex; ///< wait mutex
+		std::condition_variable m_condition; ///< wakes the sender thread
+};
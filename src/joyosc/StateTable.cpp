@@ -0,0 +1,128 @@
+/*==============================================================================
+
+	StateTable.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "StateTable.h"
+
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include "Log.h"
+
+#ifdef HAVE_SHM_OPEN
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+#endif
+
+// readers depend on the exact layout
+static_assert(sizeof(joyosc_state_device) == 448, "unexpected state device size");
+static_assert(offsetof(joyosc_state, devices) == 64, "unexpected state header size");
+
+StateTable::~StateTable() {
+	close();
+}
+
+bool StateTable::open(const std::string &name) {
+	close();
+#ifdef HAVE_SHM_OPEN
+	std::string path = (name.front() == '/' ? name : "/" + name);
+	int fd = shm_open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if(fd < 0) {
+		LOG_WARN << "StateTable: could not open " << path << ": "
+		         << strerror(errno) << std::endl;
+		return false;
+	}
+	if(ftruncate(fd, sizeof(joyosc_state)) < 0) {
+		LOG_WARN << "StateTable: could not size " << path << ": "
+		         << strerror(errno) << std::endl;
+		::close(fd);
+		shm_unlink(path.c_str());
+		return false;
+	}
+	void *map = mmap(nullptr, sizeof(joyosc_state), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(map == MAP_FAILED) {
+		LOG_WARN << "StateTable: could not map " << path << ": "
+		         << strerror(errno) << std::endl;
+		shm_unlink(path.c_str());
+		return false;
+	}
+	m_table = (joyosc_state *)map;
+	m_name = path;
+
+	// clear any previous contents, magic is set last so readers never see a
+	// partial header
+	memset(m_table, 0, sizeof(joyosc_state));
+	m_table->version = JOYOSC_STATE_VERSION;
+	m_table->size = sizeof(joyosc_state);
+	m_table->device_size = sizeof(joyosc_state_device);
+	m_table->max_devices = JOYOSC_STATE_MAX_DEVICES;
+	m_table->pid = (uint32_t)getpid();
+	__atomic_store_n(&m_table->magic, JOYOSC_STATE_MAGIC, __ATOMIC_RELEASE);
+	LOG_VERBOSE << "StateTable: opened " << m_name << std::endl;
+	return true;
+#else
+	LOG_WARN << "StateTable: shared memory not supported on this platform" << std::endl;
+	return false;
+#endif
+}
+
+void StateTable::close() {
+#ifdef HAVE_SHM_OPEN
+	if(!m_table) {return;}
+	munmap(m_table, sizeof(joyosc_state));
+	shm_unlink(m_name.c_str());
+	LOG_VERBOSE << "StateTable: closed " << m_name << std::endl;
+	m_table = nullptr;
+	m_name = "";
+#endif
+}
+
+joyosc_state_device* StateTable::add(uint32_t type, int index, const std::string &address,
+                                     const std::string &name, size_t numAxes, size_t numHats) {
+	if(!m_table) {return nullptr;}
+	for(int i = 0; i < JOYOSC_STATE_MAX_DEVICES; ++i) {
+		joyosc_state_device *device = &m_table->devices[i];
+		if(device->type != JOYOSC_STATE_UNUSED) {continue;}
+
+		// clear everything but the sequence which keeps counting
+		beginWrite(device);
+		memset((char *)device + sizeof(device->sequence), 0,
+		       sizeof(joyosc_state_device) - sizeof(device->sequence));
+		device->type = type;
+		device->index = index;
+		device->num_axes = (uint32_t)(numAxes > JOYOSC_STATE_MAX_AXES ? JOYOSC_STATE_MAX_AXES : numAxes);
+		device->num_hats = (uint32_t)(numHats > JOYOSC_STATE_MAX_HATS ? JOYOSC_STATE_MAX_HATS : numHats);
+		strncpy(device->address, address.c_str(), JOYOSC_STATE_ADDRESS_SIZE - 1);
+		strncpy(device->name, name.c_str(), JOYOSC_STATE_NAME_SIZE - 1);
+		endWrite(device);
+		return device;
+	}
+	return nullptr;
+}
+
+void StateTable::remove(joyosc_state_device *device) {
+	if(!m_table || !device) {return;}
+	beginWrite(device);
+	device->type = JOYOSC_STATE_UNUSED;
+	endWrite(device);
+}
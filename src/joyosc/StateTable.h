@@ -0,0 +1,87 @@
+/*==============================================================================
+
+	StateTable.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#include "../config.h"
+
+#include <string>
+#include <atomic>
+#include "joyosc_state.h"
+
+/// \class StateTable
+/// \brief publishes device input state in a shared memory table
+///
+/// Creates a POSIX shared memory object with the versioned layout from
+/// joyosc_state.h, ie. /dev/shm/joyosc, which local readers map & poll
+/// without system calls. Each device slot is updated with a seqlock so any
+/// number of readers can read while the event loop writes.
+///
+/// Single writer: call from the event loop thread only.
+///
+/// note: requires shm_open(), not available on Windows
+class StateTable {
+
+	public:
+
+		StateTable() {}
+		virtual ~StateTable();
+
+		/// create & map the shared memory object by name, ie. "/joyosc",
+		/// returns true on success
+		bool open(const std::string &name);
+
+		/// unmap & remove the shared memory object
+		void close();
+
+		/// returns true if open
+		inline bool isOpen() {return m_table != nullptr;}
+
+		/// get shared memory object name
+		inline const std::string& getName() {return m_name;}
+
+		/// take a free device slot & set the device info,
+		/// returns nullptr if the table is not open or full
+		joyosc_state_device* add(uint32_t type, int index, const std::string &address,
+		                         const std::string &name, size_t numAxes, size_t numHats);
+
+		/// free a device slot
+		void remove(joyosc_state_device *device);
+
+		/// start writing a device slot, makes the sequence odd
+		inline static void beginWrite(joyosc_state_device *device) {
+			uint32_t sequence = __atomic_load_n(&device->sequence, __ATOMIC_RELAXED);
+			__atomic_store_n(&device->sequence, sequence + 1, __ATOMIC_RELAXED);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		/// finish writing a device slot, makes the sequence even
+		inline static void endWrite(joyosc_state_device *device) {
+			uint32_t sequence = __atomic_load_n(&device->sequence, __ATOMIC_RELAXED);
+			__atomic_store_n(&device->sequence, sequence + 1, __ATOMIC_RELEASE);
+		}
+
+	protected:
+
+		std::string m_name = ""; ///< shared memory object name
+		joyosc_state *m_table = nullptr; ///< mapped table, if open
+};
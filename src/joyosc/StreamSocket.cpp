@@ -0,0 +1,294 @@
+/*==============================================================================
+
+	StreamSocket.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "StreamSocket.h"
+
+#ifndef _WIN32
+
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "Log.h"
+#include "OscMessage.h"
+
+// SLIP special bytes
+#define SLIP_END     ((char)0xC0)
+#define SLIP_ESC     ((char)0xDB)
+#define SLIP_ESC_END ((char)0xDC)
+#define SLIP_ESC_ESC ((char)0xDD)
+
+// reconnect backoff range in ms
+#define RETRY_MIN_MS 250
+#define RETRY_MAX_MS 5000
+
+// avoid SIGPIPE on a closed connection
+#ifdef MSG_NOSIGNAL
+	#define SEND_FLAGS MSG_NOSIGNAL
+#else
+	#define SEND_FLAGS 0
+#endif
+
+StreamSocket::StreamSocket(size_t bufferSize) {
+	m_buffer.resize(bufferSize);
+	memset(&m_address, 0, sizeof(m_address));
+}
+
+StreamSocket::~StreamSocket() {
+	close();
+}
+
+bool StreamSocket::open(const std::string &host, unsigned int port) {
+	close();
+	struct addrinfo hints, *result = nullptr;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	std::string service = std::to_string(port);
+	int ret = getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+	if(ret != 0 || !result) {
+		LOG_WARN << "StreamSocket: could not resolve " << host << ":" << port
+		         << ": " << gai_strerror(ret) << std::endl;
+		return false;
+	}
+	memcpy(&m_address, result->ai_addr, result->ai_addrlen);
+	m_addressLength = result->ai_addrlen;
+	freeaddrinfo(result);
+
+	// resolve once, reconnects only retry the connection
+	m_host = host + ":" + service;
+	m_retryMS = RETRY_MIN_MS;
+	m_retryTime = std::chrono::steady_clock::now();
+	connect();
+	return true;
+}
+
+void StreamSocket::close() {
+	if(m_socket >= 0) {
+		::close(m_socket);
+		m_socket = -1;
+	}
+	m_state = DISCONNECTED;
+	m_used = 0;
+	m_messages = 0;
+	m_frames = 0;
+	m_bundle = false;
+	m_blocked = false;
+}
+
+bool StreamSocket::add(const char *data, size_t size) {
+	endBundle();
+	if(!reserve(size)) {
+		flush(); // make room, the kernel send buffer may have space
+		if(!reserve(size)) {
+			if(!m_blocked) {dropped++;} // too large
+			return false;
+		}
+	}
+	appendEnd();
+	append(data, size);
+	appendEnd();
+	m_messages++;
+	m_frames++;
+	return true;
+}
+
+// bundle: "#bundle\0", 8 byte timetag, then size prefixed elements,
+// escaped as they are added so the frame can stay open until flush()
+bool StreamSocket::bundle(const char *data, size_t size, lo_timetag timetag) {
+	if(m_bundle && (timetag.sec != m_timetag.sec || timetag.frac != m_timetag.frac)) {
+		endBundle();
+	}
+	if(!reserve(size + 4 + (m_bundle ? 0 : 16))) {
+		flush(); // ends the bundle
+		if(!reserve(size + 4 + 16)) {
+			if(!m_blocked) {dropped++;} // too large
+			return false;
+		}
+	}
+	if(!m_bundle) {
+		char header[16];
+		memcpy(header, "#bundle\0", 8);
+		OscMessage::writeInt32(header + 8, timetag.sec);
+		OscMessage::writeInt32(header + 12, timetag.frac);
+		appendEnd();
+		append(header, 16);
+		m_bundle = true;
+		m_timetag = timetag;
+		m_frames++;
+	}
+	char length[4];
+	OscMessage::writeInt32(length, (uint32_t)size);
+	append(length, 4);
+	append(data, size);
+	m_messages++;
+	return true;
+}
+
+void StreamSocket::endBundle() {
+	if(!m_bundle) {return;}
+	appendEnd();
+	m_bundle = false;
+}
+
+void StreamSocket::flush() {
+	endBundle();
+	writeFrames();
+	m_blocked = (m_used > 0);
+}
+
+// PROTECTED
+
+// all pending frames are written with one call, a partial write keeps the
+// rest for the next flush instead of blocking
+void StreamSocket::writeFrames() {
+	if(m_state != CONNECTED) {
+		connect();
+		if(m_state != CONNECTED) {return;}
+	}
+	if(m_used == 0) {return;}
+	ssize_t ret = -1;
+	do {
+		ret = send(m_socket, m_buffer.data(), m_used, SEND_FLAGS);
+		writes++;
+	} while(ret < 0 && errno == EINTR);
+	if(ret < 0) {
+		if(errno != EAGAIN && errno != EWOULDBLOCK) {
+			disconnect("write failed", errno);
+		}
+		return;
+	}
+	if((size_t)ret < m_used) {
+		memmove(m_buffer.data(), m_buffer.data() + ret, m_used - ret);
+		m_used -= ret;
+		return;
+	}
+	messagesSent += m_messages;
+	framesSent += m_frames;
+	m_used = 0;
+	m_messages = 0;
+	m_frames = 0;
+}
+
+void StreamSocket::connect() {
+	if(m_addressLength == 0) {return;}
+	if(m_state == DISCONNECTED) {
+		if(std::chrono::steady_clock::now() < m_retryTime) {return;}
+		m_socket = socket(m_address.ss_family, SOCK_STREAM, 0);
+		if(m_socket < 0) {
+			disconnect("could not create socket", errno);
+			return;
+		}
+		fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+		int on = 1;
+		setsockopt(m_socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+		if(::connect(m_socket, (struct sockaddr *)&m_address, m_addressLength) < 0 &&
+		   errno != EINPROGRESS) {
+			disconnect("connect failed", errno);
+			return;
+		}
+		m_state = CONNECTING;
+	}
+	if(m_state == CONNECTING) {
+		// check without waiting if the connection has finished
+		struct pollfd fd = {m_socket, POLLOUT, 0};
+		if(poll(&fd, 1, 0) <= 0) {return;}
+		int error = 0;
+		socklen_t length = sizeof(error);
+		getsockopt(m_socket, SOL_SOCKET, SO_ERROR, &error, &length);
+		if(error != 0) {
+			disconnect("connect failed", error);
+			return;
+		}
+		int nodelay = 1;
+		setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+		m_state = CONNECTED;
+		m_retryMS = RETRY_MIN_MS;
+		connects++;
+		LOG_VERBOSE << "StreamSocket: connected to " << m_host << std::endl;
+	}
+}
+
+void StreamSocket::disconnect(const char *reason, int error) {
+	if(m_state == CONNECTED) {
+		LOG_WARN << "StreamSocket: " << m_host << " " << reason << ": "
+		         << strerror(error) << ", reconnecting" << std::endl;
+
+		// the receiver may have gotten part of the pending frames
+		dropped += m_messages;
+		m_used = 0;
+		m_messages = 0;
+		m_frames = 0;
+		m_bundle = false;
+	}
+	else {
+		// nothing written yet, keep pending frames for the next connection
+		LOG_DEBUG << "StreamSocket: " << m_host << " " << reason << ": "
+		          << strerror(error) << std::endl;
+	}
+	if(m_socket >= 0) {
+		::close(m_socket);
+		m_socket = -1;
+	}
+	m_state = DISCONNECTED;
+	errors++;
+
+	m_retryTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_retryMS);
+	m_retryMS = (m_retryMS * 2 > RETRY_MAX_MS ? RETRY_MAX_MS : m_retryMS * 2);
+}
+
+// worst case: every byte is escaped, plus the frame END bytes
+bool StreamSocket::reserve(size_t size) {
+	return m_used + (size * 2) + 2 <= m_buffer.size();
+}
+
+void StreamSocket::append(const char *data, size_t size) {
+	char *dest = m_buffer.data() + m_used;
+	for(size_t i = 0; i < size; ++i) {
+		switch(data[i]) {
+			case SLIP_END:
+				*dest++ = SLIP_ESC;
+				*dest++ = SLIP_ESC_END;
+				break;
+			case SLIP_ESC:
+				*dest++ = SLIP_ESC;
+				*dest++ = SLIP_ESC_ESC;
+				break;
+			default:
+				*dest++ = data[i];
+				break;
+		}
+	}
+	m_used = dest - m_buffer.data();
+}
+
+void StreamSocket::appendEnd() {
+	m_buffer[m_used++] = SLIP_END;
+}
+
+#endif
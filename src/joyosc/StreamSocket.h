@@ -0,0 +1,150 @@
+/*==============================================================================
+
+	StreamSocket.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#pragma once
+
+#ifndef _WIN32
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/socket.h>
+#include <lo/lo.h>
+
+/// \class StreamSocket
+/// \brief TCP socket which sends SLIP framed OSC packets
+///
+/// Packets are framed using OSC 1.1 double END SLIP encoding & collected into
+/// a preallocated buffer until flush() writes all pending frames with one
+/// system call. TCP_NODELAY is set so frames are not delayed by Nagle's
+/// algorithm.
+///
+/// Connecting is non-blocking & never stalls the caller: frames are buffered
+/// while connecting & flush() retries a lost connection with a backoff.
+/// Frames which do not fit into the buffer are refused whole while frames are
+/// still pending, see isBlocked(). Unsent frames are dropped when an
+/// established connection is lost as the receiver may have only gotten part
+/// of them. Not thread safe.
+///
+/// note: not available on Windows
+class StreamSocket {
+
+	public:
+
+		/// create with buffer size in bytes
+		StreamSocket(size_t bufferSize=65536);
+		virtual ~StreamSocket();
+
+		/// resolve host & start connecting, returns false if the host could
+		/// not be resolved
+		bool open(const std::string &host, unsigned int port);
+
+		/// close socket, drops any pending frames
+		void close();
+
+		/// returns true if connected
+		inline bool isConnected() {return m_state == CONNECTED;}
+
+		/// add an encoded message as a single frame, ends the current bundle
+		/// returns false if the buffer is full as the socket is blocked, see
+		/// isBlocked(), or if dropped as the message is too large
+		bool add(const char *data, size_t size);
+
+		/// add an encoded message to the current bundle frame, starts a new
+		/// bundle with the given timetag if none or if the timetag differs
+		/// returns false if the buffer is full as the socket is blocked, see
+		/// isBlocked(), or if dropped as the message is too large
+		bool bundle(const char *data, size_t size, lo_timetag timetag);
+
+		/// end the current bundle frame, if any
+		void endBundle();
+
+		/// is there a bundle in progress?
+		inline bool inBundle() {return m_bundle;}
+
+		/// write all pending frames, reconnects if needed
+		void flush();
+
+		/// returns true if the last flush left frames pending, ie. while
+		/// connecting or if the kernel send buffer is full
+		inline bool isBlocked() {return m_blocked;}
+
+		/// number of pending bytes
+		inline size_t pending() {return m_used;}
+
+	/// \section counters
+
+		uint64_t messagesSent = 0; ///< total messages sent
+		uint64_t framesSent = 0; ///< total frames sent
+		uint64_t writes = 0; ///< total write system calls
+		uint64_t errors = 0; ///< total connection errors
+		uint64_t dropped = 0; ///< total messages dropped
+		uint64_t connects = 0; ///< total successful connections
+
+	protected:
+
+		/// connection state
+		enum State {
+			DISCONNECTED,
+			CONNECTING,
+			CONNECTED
+		};
+
+		/// start connecting if the retry time has passed, or check if a
+		/// connection in progress has finished
+		void connect();
+
+		/// close the socket after a failed connection or write & schedule a
+		/// reconnect, drops any pending frames if connected
+		void disconnect(const char *reason, int error);
+
+		/// write pending frames, keeps the rest after a partial write
+		void writeFrames();
+
+		/// returns true if there is room for size bytes, escaped, plus the
+		/// END bytes
+		bool reserve(size_t size);
+
+		/// append SLIP escaped bytes
+		void append(const char *data, size_t size);
+
+		/// append a SLIP END byte
+		void appendEnd();
+
+		int m_socket = -1; ///< socket file descriptor
+		State m_state = DISCONNECTED; ///< connection state
+		struct sockaddr_storage m_address; ///< destination address
+		socklen_t m_addressLength = 0; ///< destination address length
+		std::string m_host = ""; ///< destination host:port for printing
+		std::chrono::steady_clock::time_point m_retryTime; ///< next connect try
+		unsigned int m_retryMS = 0; ///< current reconnect backoff in ms
+
+		std::vector<char> m_buffer; ///< encoded frames
+		size_t m_used = 0; ///< used buffer bytes
+		size_t m_messages = 0; ///< number of pending messages
+		size_t m_frames = 0; ///< number of pending frames
+		bool m_bundle = false; ///< is the last frame an open bundle?
+		bool m_blocked = false; ///< were frames left pending on the last flush?
+		lo_timetag m_timetag = {0, 0}; ///< open bundle timetag
+};
+
+#endif
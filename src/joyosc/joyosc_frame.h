@@ -0,0 +1,258 @@
+/*==============================================================================
+
+	joyosc_frame.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+/* joyosc binary frame format & reference decoder
+ *
+ * A destination with <sending format="frames"> sends device events as
+ * fixed-size binary records packed many per datagram instead of one OSC
+ * message each. Notifications, query replies, & state snapshots are still
+ * sent as OSC packets to the same destination, so receivers tell them apart
+ * by the first 4 bytes: frame datagrams start with the "JOYF" magic, OSC
+ * packets with '/' or "#bun".
+ *
+ * All values are little-endian. A datagram is a 16 byte header followed by
+ * count records of record_size bytes each:
+ *
+ *     offset  size  header field
+ *     0       4     magic, JOYOSC_FRAME_MAGIC
+ *     4       2     version, JOYOSC_FRAME_VERSION
+ *     6       2     record size in bytes, at least JOYOSC_FRAME_RECORD_SIZE
+ *     8       2     number of records
+ *     10      2     reserved, 0
+ *     12      4     datagram sequence number, +1 per datagram, a gap means
+ *                   datagrams were lost
+ *
+ *     offset  size  record field
+ *     0       4     time: SDL event timestamp in ms since joyosc started
+ *     4       4     sequence: per-device event sequence number, 0 if not
+ *                   syncing, see joyosc --sync
+ *     8       2     time_us: us within the ms, if known, ie. sensors
+ *     10      2     device: device index, see /joyosc/query INDEX & the
+ *                   /joyosc/notifications/open index argument
+ *     12      1     type: JOYOSC_FRAME_BUTTON, etc
+ *     13      1     flags: JOYOSC_FRAME_FLOAT if values are floats
+ *     14      2     id: input id, see below
+ *     16      2     touchpad: touchpad index, touchpad events only
+ *     18      2     finger: finger index, touchpad events only
+ *     20      12    values: 3 signed 32 bit ints or 32 bit floats
+ *
+ * Game controller button & axis ids follow the numeric id schema, see
+ * /joyosc/query/schema, inputs remapped to names outside of the schema have
+ * id -1. Joystick ids are the joystick input numbers after remapping, sensor
+ * ids are SDL_SensorType values, & touchpad ids are JOYOSC_FRAME_TOUCH_*.
+ *
+ *     type      values
+ *     button    state 0 or 1
+ *     axis      value -32768 to 32767, or -1 to 1 float if normalized
+ *     ball      relative x & y motion
+ *     hat       hat value, SDL_HAT_* bits
+ *     touchpad  x, y, & pressure floats 0 to 1
+ *     sensor    x, y, & z floats
+ *
+ * Reading a datagram:
+ *
+ *     uint32_t sequence;
+ *     int count = joyosc_frame_count(data, size, &sequence);
+ *     for(int i = 0; i < count; ++i) {
+ *         joyosc_frame_record record;
+ *         joyosc_frame_read(data, i, &record);
+ *         printf("%d %s %d\n", record.device,
+ *                joyosc_frame_type_name(record.type), record.id);
+ *     }
+ *
+ * Newer versions may append fields to records, so readers use the record
+ * size from the header. The version changes if existing fields change.
+ *
+ * note: plain C, reads & writes byte-wise so it works on any host byte order
+ *       & alignment
+ */
+#ifndef JOYOSC_FRAME_H
+#define JOYOSC_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JOYOSC_FRAME_MAGIC       0x46594F4A /* "JOYF" */
+#define JOYOSC_FRAME_VERSION     1
+
+#define JOYOSC_FRAME_HEADER_SIZE 16
+#define JOYOSC_FRAME_RECORD_SIZE 32
+
+/* record types */
+#define JOYOSC_FRAME_BUTTON   0
+#define JOYOSC_FRAME_AXIS     1
+#define JOYOSC_FRAME_BALL     2
+#define JOYOSC_FRAME_HAT      3
+#define JOYOSC_FRAME_TOUCHPAD 4
+#define JOYOSC_FRAME_SENSOR   5
+
+/* record flags */
+#define JOYOSC_FRAME_FLOAT    0x01 /* values are floats, otherwise ints */
+
+/* touchpad record ids */
+#define JOYOSC_FRAME_TOUCH_DOWN   0
+#define JOYOSC_FRAME_TOUCH_MOTION 1
+#define JOYOSC_FRAME_TOUCH_UP     2
+
+/* record value */
+typedef union joyosc_frame_value {
+	int32_t i;
+	float f;
+} joyosc_frame_value;
+
+/* decoded record */
+typedef struct joyosc_frame_record {
+	uint32_t time;     /* SDL event timestamp in ms */
+	uint32_t sequence; /* per-device event sequence number, 0 if not syncing */
+	uint16_t time_us;  /* us within the ms, if known */
+	uint16_t device;   /* device index */
+	uint8_t type;      /* JOYOSC_FRAME_BUTTON, etc */
+	uint8_t flags;     /* JOYOSC_FRAME_FLOAT, etc */
+	int16_t id;        /* input id, -1 if unknown */
+	int16_t touchpad;  /* touchpad index */
+	int16_t finger;    /* touchpad finger index */
+	joyosc_frame_value values[3];
+} joyosc_frame_record;
+
+/* returns the record type name, ie. "button", or "unknown" */
+static inline const char* joyosc_frame_type_name(uint8_t type) {
+	static const char *names[] = {
+		"button", "axis", "ball", "hat", "touchpad", "sensor"
+	};
+	return (type <= JOYOSC_FRAME_SENSOR ? names[type] : "unknown");
+}
+
+/* little-endian reads */
+
+static inline uint16_t joyosc_frame_get16(const void *src) {
+	const uint8_t *p = (const uint8_t *)src;
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t joyosc_frame_get32(const void *src) {
+	const uint8_t *p = (const uint8_t *)src;
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+	       ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* little-endian writes */
+
+static inline void joyosc_frame_put16(void *dest, uint16_t value) {
+	uint8_t *p = (uint8_t *)dest;
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void joyosc_frame_put32(void *dest, uint32_t value) {
+	uint8_t *p = (uint8_t *)dest;
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+/* returns the number of records in a datagram & sets the datagram sequence
+   number, if not NULL, returns -1 if the data is not a frame datagram, ie.
+   an OSC packet, or if the version is not supported or the size is short */
+static inline int joyosc_frame_count(const void *data, size_t size, uint32_t *sequence) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint16_t recordSize, count;
+	if(size < JOYOSC_FRAME_HEADER_SIZE ||
+	   joyosc_frame_get32(p) != JOYOSC_FRAME_MAGIC ||
+	   joyosc_frame_get16(p + 4) != JOYOSC_FRAME_VERSION) {
+		return -1;
+	}
+	recordSize = joyosc_frame_get16(p + 6);
+	count = joyosc_frame_get16(p + 8);
+	if(recordSize < JOYOSC_FRAME_RECORD_SIZE ||
+	   size < JOYOSC_FRAME_HEADER_SIZE + (size_t)count * recordSize) {
+		return -1;
+	}
+	if(sequence) {*sequence = joyosc_frame_get32(p + 12);}
+	return count;
+}
+
+/* decode record at index from a datagram, check the count first with
+   joyosc_frame_count() */
+static inline void joyosc_frame_read(const void *data, int index,
+                                     joyosc_frame_record *record) {
+	const uint8_t *p = (const uint8_t *)data;
+	int i;
+	p += JOYOSC_FRAME_HEADER_SIZE + (size_t)index * joyosc_frame_get16(p + 6);
+	record->time = joyosc_frame_get32(p);
+	record->sequence = joyosc_frame_get32(p + 4);
+	record->time_us = joyosc_frame_get16(p + 8);
+	record->device = joyosc_frame_get16(p + 10);
+	record->type = p[12];
+	record->flags = p[13];
+	record->id = (int16_t)joyosc_frame_get16(p + 14);
+	record->touchpad = (int16_t)joyosc_frame_get16(p + 16);
+	record->finger = (int16_t)joyosc_frame_get16(p + 18);
+	for(i = 0; i < 3; ++i) {
+		uint32_t value = joyosc_frame_get32(p + 20 + i * 4);
+		memcpy(&record->values[i], &value, 4); /* same bits for int & float */
+	}
+}
+
+/* encode a datagram header with the number of records & datagram sequence
+   number into dest, JOYOSC_FRAME_HEADER_SIZE bytes */
+static inline void joyosc_frame_write_header(void *dest, uint16_t count, uint32_t sequence) {
+	uint8_t *p = (uint8_t *)dest;
+	joyosc_frame_put32(p, JOYOSC_FRAME_MAGIC);
+	joyosc_frame_put16(p + 4, JOYOSC_FRAME_VERSION);
+	joyosc_frame_put16(p + 6, JOYOSC_FRAME_RECORD_SIZE);
+	joyosc_frame_put16(p + 8, count);
+	joyosc_frame_put16(p + 10, 0);
+	joyosc_frame_put32(p + 12, sequence);
+}
+
+/* encode a record into dest, JOYOSC_FRAME_RECORD_SIZE bytes */
+static inline void joyosc_frame_write(void *dest, const joyosc_frame_record *record) {
+	uint8_t *p = (uint8_t *)dest;
+	int i;
+	joyosc_frame_put32(p, record->time);
+	joyosc_frame_put32(p + 4, record->sequence);
+	joyosc_frame_put16(p + 8, record->time_us);
+	joyosc_frame_put16(p + 10, record->device);
+	p[12] = record->type;
+	p[13] = record->flags;
+	joyosc_frame_put16(p + 14, (uint16_t)record->id);
+	joyosc_frame_put16(p + 16, (uint16_t)record->touchpad);
+	joyosc_frame_put16(p + 18, (uint16_t)record->finger);
+	for(i = 0; i < 3; ++i) {
+		uint32_t value;
+		memcpy(&value, &record->values[i], 4);
+		joyosc_frame_put32(p + 20 + i * 4, value);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
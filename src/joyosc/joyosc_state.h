@@ -0,0 +1,159 @@
+/*==============================================================================
+
+	joyosc_state.h
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+/* joyosc shared memory device state table layout & reader functions
+ *
+ * When started with --state-table NAME, joyosc publishes the current input
+ * state of each open device in a POSIX shared memory object, ie.
+ * /dev/shm/joyosc on Linux. Readers map it read only & poll it without
+ * system calls or locks:
+ *
+ *     const joyosc_state *state = joyosc_state_open("/joyosc");
+ *     joyosc_state_device device;
+ *     if(state && joyosc_state_read(&state->devices[0], &device)) {
+ *         printf("%s buttons: %llx\n", device.address, device.buttons);
+ *     }
+ *     joyosc_state_close(state);
+ *
+ * Each device slot is written with a seqlock: the sequence counter is odd
+ * while the slot is being written, so joyosc_state_read() copies the slot
+ * until it gets a consistent snapshot. The sequence counter also changes
+ * with every update, so readers can check it to see if anything changed.
+ *
+ * The layout is versioned: readers must check the magic & version numbers,
+ * joyosc_state_open() does this. Slots are freed when a device is closed &
+ * may be reused by the next device which is opened.
+ *
+ * note: plain C, requires GCC or Clang atomic builtins & POSIX shm_open()
+ */
+#ifndef JOYOSC_STATE_H
+#define JOYOSC_STATE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JOYOSC_STATE_MAGIC       0x534F594A /* "JOYS" */
+#define JOYOSC_STATE_VERSION     1
+
+#define JOYOSC_STATE_MAX_DEVICES 16
+#define JOYOSC_STATE_MAX_AXES    32
+#define JOYOSC_STATE_MAX_HATS    8
+#define JOYOSC_STATE_MAX_SENSORS 6
+#define JOYOSC_STATE_ADDRESS_SIZE 64
+#define JOYOSC_STATE_NAME_SIZE   128
+
+/* device slot types */
+#define JOYOSC_STATE_UNUSED         0
+#define JOYOSC_STATE_JOYSTICK       1
+#define JOYOSC_STATE_GAMECONTROLLER 2
+
+/* sensor values */
+typedef struct joyosc_state_sensor {
+	int32_t type;      /* SDL_SensorType, 0 if unused */
+	float values[3];   /* x, y, z */
+} joyosc_state_sensor;
+
+/* device slot, 448 bytes */
+typedef struct joyosc_state_device {
+	uint32_t sequence;    /* seqlock counter, odd while being written */
+	uint32_t type;        /* slot type, JOYOSC_STATE_UNUSED if free */
+	int32_t index;        /* device index, ie. 0 for "/gc0" */
+	uint32_t num_axes;    /* number of used axes */
+	uint32_t num_hats;    /* number of used hats */
+	uint32_t num_sensors; /* number of used sensors */
+	uint64_t buttons;     /* button bitfield, bit n is set if button n is pressed */
+	int16_t axes[JOYOSC_STATE_MAX_AXES]; /* raw axis values -32768 - 32767 */
+	uint8_t hats[JOYOSC_STATE_MAX_HATS]; /* hat values, SDL_HAT_* bits */
+	joyosc_state_sensor sensors[JOYOSC_STATE_MAX_SENSORS];
+	char address[JOYOSC_STATE_ADDRESS_SIZE]; /* device OSC address, ie. "/gc0" */
+	char name[JOYOSC_STATE_NAME_SIZE];       /* device name */
+	uint8_t reserved[56]; /* pad to a multiple of 64 bytes, ie. cache lines */
+} joyosc_state_device;
+
+/* state table, starts with a 64 byte header */
+typedef struct joyosc_state {
+	uint32_t magic;       /* JOYOSC_STATE_MAGIC */
+	uint32_t version;     /* JOYOSC_STATE_VERSION */
+	uint32_t size;        /* total size in bytes */
+	uint32_t device_size; /* device slot size in bytes */
+	uint32_t max_devices; /* number of device slots */
+	uint32_t pid;         /* joyosc process id */
+	uint32_t reserved[10];
+	joyosc_state_device devices[JOYOSC_STATE_MAX_DEVICES];
+} joyosc_state;
+
+#if !defined(_WIN32) && (defined(__GNUC__) || defined(__clang__))
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* map state table by shared memory name read only, ie. "/joyosc",
+   returns NULL if not found or if the layout version does not match */
+static inline const joyosc_state* joyosc_state_open(const char *name) {
+	const joyosc_state *state = NULL;
+	int fd = shm_open(name, O_RDONLY, 0);
+	if(fd < 0) {return NULL;}
+	void *map = mmap(NULL, sizeof(joyosc_state), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED) {return NULL;}
+	state = (const joyosc_state *)map;
+	if(state->magic != JOYOSC_STATE_MAGIC ||
+	   state->version != JOYOSC_STATE_VERSION ||
+	   state->device_size != sizeof(joyosc_state_device)) {
+		munmap(map, sizeof(joyosc_state));
+		return NULL;
+	}
+	return state;
+}
+
+/* unmap state table */
+static inline void joyosc_state_close(const joyosc_state *state) {
+	if(state) {munmap((void *)state, sizeof(joyosc_state));}
+}
+
+/* copy a consistent snapshot of a device slot into dest,
+   returns 1 if the slot is in use or 0 if it is free */
+static inline int joyosc_state_read(const joyosc_state_device *device,
+                                    joyosc_state_device *dest) {
+	uint32_t begin, end;
+	do {
+		begin = __atomic_load_n(&device->sequence, __ATOMIC_ACQUIRE);
+		memcpy(dest, (const void *)device, sizeof(joyosc_state_device));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		end = __atomic_load_n(&device->sequence, __ATOMIC_RELAXED);
+	} while((begin & 1) || begin != end);
+	return dest->type != JOYOSC_STATE_UNUSED;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -48,7 +48,7 @@ static const SDL_SensorType s_sensors[] = {
 };
 
 /// return sensor name from enum
-inline std::string SensorName(SDL_SensorType sensor) {
+inline const char* SensorName(SDL_SensorType sensor) {
 	switch(sensor) {
 		case SDL_SENSOR_ACCEL:   return "accel";
 		case SDL_SENSOR_GYRO:    return "gyro";
@@ -0,0 +1,86 @@
+/*==============================================================================
+
+	bench_encode.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <lo/lo.h>
+#include "OscMessage.h"
+
+// encodes a typical game controller axis message with OscMessage into a stack
+// buffer, then with a heap allocated lo_message serialised into the same
+// buffer as joyosc did before OscMessage
+
+typedef std::chrono::steady_clock Clock;
+
+static const char *path = "/joyosc/devices/gc0/axis";
+
+// keeps the optimizer from removing the encoding
+static volatile size_t s_sink = 0;
+
+// returns ns per iteration since start
+static double nsPer(Clock::time_point start, int iterations) {
+	std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+	return elapsed.count() / iterations;
+}
+
+int main(int argc, char **argv) {
+	int iterations = (argc > 1 ? atoi(argv[1]) : 1000000);
+	if(iterations <= 0) {
+		std::cerr << "usage: bench_encode [iterations]" << std::endl;
+		return EXIT_FAILURE;
+	}
+	char buffer[4096];
+
+	float value = 0;
+	Clock::time_point start = Clock::now();
+	for(int i = 0; i < iterations; ++i) {
+		OscMessage message(path);
+		message.addString("leftx");
+		message.addFloat(value);
+		s_sink += message.write(buffer, sizeof(buffer));
+		value += 0.000001f;
+	}
+	double oscMessageNS = nsPer(start, iterations);
+
+	value = 0;
+	start = Clock::now();
+	for(int i = 0; i < iterations; ++i) {
+		lo_message message = lo_message_new();
+		lo_message_add_string(message, "leftx");
+		lo_message_add_float(message, value);
+		size_t size = sizeof(buffer);
+		lo_message_serialise(message, path, buffer, &size);
+		s_sink += size;
+		lo_message_free(message);
+		value += 0.000001f;
+	}
+	double loMessageNS = nsPer(start, iterations);
+
+	std::cout << "bench_encode: " << path << " sf, "
+	          << iterations << " iterations" << std::endl
+	          << "  OscMessage: " << oscMessageNS << " ns/message" << std::endl
+	          << "  lo_message: " << loMessageNS << " ns/message" << std::endl
+	          << "  speedup:    " << loMessageNS / oscMessageNS << "x" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*==============================================================================
+
+	bench_handlers.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "Joystick.h"
+#include "GameController.h"
+
+// times handleEvent() for synthetic axis & button events on a virtual
+// joystick & game controller for each flag combination, event streaming is
+// disabled so only event handling & state updates are timed, only uses API
+// which predates the flag-specialized handlers so it can time both
+
+typedef std::chrono::steady_clock Clock;
+
+// triggers on the positive half axis so they start released
+static const char *mapping = ",joyosc virtual controller,"
+	"a:b0,b:b1,x:b2,y:b3,back:b4,guide:b5,start:b6,leftstick:b7,rightstick:b8,"
+	"leftshoulder:b9,rightshoulder:b10,dpup:b11,dpdown:b12,dpleft:b13,dpright:b14,"
+	"leftx:a0,lefty:a1,rightx:a2,righty:a3,lefttrigger:+a4,righttrigger:+a5,";
+
+// handle alternating axis & button events, returns ns per event
+static double run(Device &device, SDL_Event &axis, SDL_Event &button,
+                  Sint16 &axisValue, Uint8 &buttonState, Uint32 buttonUp,
+                  Uint32 buttonDown, int iterations) {
+	Clock::time_point start = Clock::now();
+	for(int i = 0; i < iterations; ++i) {
+		axisValue = (i & 1 ? 20000 : -20000); // never a repeat
+		device.handleEvent(&axis);
+		buttonState = (i & 1 ? SDL_PRESSED : SDL_RELEASED);
+		button.type = (i & 1 ? buttonDown : buttonUp);
+		device.handleEvent(&button);
+	}
+	std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+	return elapsed.count() / (iterations * 2);
+}
+
+int main(int argc, char **argv) {
+	int iterations = (argc > 1 ? atoi(argv[1]) : 1000000);
+	if(iterations <= 0) {
+		std::cerr << "usage: bench_handlers [iterations]" << std::endl;
+		return EXIT_FAILURE;
+	}
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+	if(SDL_Init(SDL_INIT_GAMECONTROLLER) < 0) {
+		std::cerr << "could not initialize SDL: " << SDL_GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+	int sdlIndex = SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER,
+		SDL_CONTROLLER_AXIS_MAX, 15, 0);
+	if(sdlIndex < 0) {
+		std::cerr << "could not attach virtual joystick: " << SDL_GetError() << std::endl;
+		SDL_Quit();
+		return EXIT_FAILURE;
+	}
+	char guid[33];
+	SDL_JoystickGetGUIDString(SDL_JoystickGetDeviceGUID(sdlIndex), guid, sizeof(guid));
+	GameController::addMappingString(guid + std::string(mapping));
+	Device::streamEvents = false;
+	Device::printEvents = false;
+
+	DeviceIndex index;
+	index.index = 0;
+	index.sdlIndex = sdlIndex;
+
+	std::cout << "bench_handlers: " << iterations * 2 << " events each" << std::endl;
+
+	GameController controller;
+	if(!controller.open(index, nullptr)) {
+		std::cerr << "could not open virtual controller" << std::endl;
+		return EXIT_FAILURE;
+	}
+	SDL_Event axis, button;
+	SDL_zero(axis);
+	SDL_zero(button);
+	axis.type = SDL_CONTROLLERAXISMOTION;
+	axis.caxis.which = controller.getInstanceID();
+	axis.caxis.axis = SDL_CONTROLLER_AXIS_LEFTX;
+	button.cbutton.which = controller.getInstanceID();
+	button.cbutton.button = SDL_CONTROLLER_BUTTON_A;
+	for(int flags = 0; flags < 4; ++flags) {
+		controller.setNormalizeAxes(flags & 1);
+		controller.setTriggersAsAxes(flags & 2);
+		double ns = run(controller, axis, button, axis.caxis.value, button.cbutton.state,
+			SDL_CONTROLLERBUTTONUP, SDL_CONTROLLERBUTTONDOWN, iterations);
+		std::cout << "  GameController normalize " << (flags & 1)
+		          << " triggers as axes " << ((flags & 2) >> 1)
+		          << ": " << ns << " ns/event" << std::endl;
+	}
+	controller.close();
+
+	Joystick joystick;
+	if(!joystick.open(index, nullptr)) {
+		std::cerr << "could not open virtual joystick" << std::endl;
+		return EXIT_FAILURE;
+	}
+	SDL_zero(axis);
+	SDL_zero(button);
+	axis.type = SDL_JOYAXISMOTION;
+	axis.jaxis.which = joystick.getInstanceID();
+	axis.jaxis.axis = 0;
+	button.jbutton.which = joystick.getInstanceID();
+	button.jbutton.button = 0;
+	for(int flags = 0; flags < 2; ++flags) {
+		joystick.setNormalizeAxes(flags & 1);
+		double ns = run(joystick, axis, button, axis.jaxis.value, button.jbutton.state,
+			SDL_JOYBUTTONUP, SDL_JOYBUTTONDOWN, iterations);
+		std::cout << "  Joystick normalize " << (flags & 1)
+		          << ": " << ns << " ns/event" << std::endl;
+	}
+	joystick.close();
+
+	SDL_JoystickDetachVirtual(sdlIndex);
+	SDL_Quit();
+	return EXIT_SUCCESS;
+#else
+	std::cout << "bench_handlers: skipped, virtual joysticks require SDL 2.0.14" << std::endl;
+	return EXIT_SUCCESS;
+#endif
+}
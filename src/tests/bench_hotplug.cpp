@@ -0,0 +1,169 @@
+/*==============================================================================
+
+	bench_hotplug.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "DeviceManager.h"
+#include "GameController.h"
+
+// attaches & detaches batches of SDL virtual controllers through the
+// DeviceManager hotplug path, checks the device indices after each batch,
+// then times event dispatch to the last device with a full batch open,
+// event streaming is disabled so only lookups & handling are timed
+
+typedef std::chrono::steady_clock Clock;
+
+// triggers on the positive half axis so they start released
+static const char *mapping = ",joyosc virtual controller,"
+	"a:b0,b:b1,x:b2,y:b3,back:b4,guide:b5,start:b6,leftstick:b7,rightstick:b8,"
+	"leftshoulder:b9,rightshoulder:b10,dpup:b11,dpdown:b12,dpleft:b13,dpright:b14,"
+	"leftx:a0,lefty:a1,rightx:a2,righty:a3,lefttrigger:+a4,righttrigger:+a5,";
+
+// ms since start
+static double msSince(Clock::time_point start) {
+	std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+	return elapsed.count();
+}
+
+// handle SDL events & open pending devices until done, like the run loop
+static void update(DeviceManager &manager) {
+	SDL_Event event;
+	while(SDL_PollEvent(&event)) {
+		manager.handleEvent(&event);
+	}
+	while(manager.isOpening()) {
+		manager.openPending();
+		while(SDL_PollEvent(&event)) {
+			manager.handleEvent(&event);
+		}
+	}
+}
+
+// returns true if devices 0 - count-1 are open at their own index
+static bool checkIndices(DeviceManager &manager, size_t count) {
+	if(manager.size() != count) {return false;}
+	for(size_t i = 0; i < count; ++i) {
+		Device *device = manager.get((int)i);
+		if(!device || device->getIndex() != (int)i) {return false;}
+	}
+	return true;
+}
+
+// detach all virtual joysticks, last first as indices shift
+static void detachAll() {
+	for(int i = SDL_NumJoysticks() - 1; i >= 0; --i) {
+		if(SDL_JoystickIsVirtual(i)) {SDL_JoystickDetachVirtual(i);}
+	}
+}
+
+int main(int argc, char **argv) {
+	int rounds = (argc > 1 ? atoi(argv[1]) : 10);
+	int batch = (argc > 2 ? atoi(argv[2]) : 128); // well past 64 devices
+	if(rounds <= 0 || batch <= 0) {
+		std::cerr << "usage: bench_hotplug [rounds] [devices per round]" << std::endl;
+		return EXIT_FAILURE;
+	}
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+	if(SDL_Init(SDL_INIT_GAMECONTROLLER) < 0) {
+		std::cerr << "could not initialize SDL: " << SDL_GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+	Sender sender; // no destinations, notifications go nowhere
+	sender.start();
+	Device::sender = &sender;
+	Device::streamEvents = false;
+	DeviceManager manager;
+
+	std::cout << "bench_hotplug: " << rounds << " rounds of "
+	          << batch << " devices" << std::endl;
+
+	double attachMS = 0, detachMS = 0;
+	bool mapped = false;
+	for(int r = 0; r < rounds; ++r) {
+		Clock::time_point start = Clock::now();
+		for(int i = 0; i < batch; ++i) {
+			int sdlIndex = SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER,
+				SDL_CONTROLLER_AXIS_MAX, 15, 0);
+			if(sdlIndex < 0) {
+				std::cerr << "could not attach virtual joystick: " << SDL_GetError() << std::endl;
+				return EXIT_FAILURE;
+			}
+			if(!mapped) { // all share the same guid
+				char guid[33];
+				SDL_JoystickGetGUIDString(SDL_JoystickGetDeviceGUID(sdlIndex), guid, sizeof(guid));
+				GameController::addMappingString(guid + std::string(mapping));
+				mapped = true;
+			}
+		}
+		update(manager);
+		attachMS += msSince(start);
+		if(!checkIndices(manager, (size_t)batch)) {
+			std::cerr << "round " << r << ": devices not at indices 0 - "
+			          << batch - 1 << " after attaching" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// keep the device with the highest index for the dispatch timing
+		if(r == rounds - 1) {break;}
+		start = Clock::now();
+		detachAll();
+		update(manager);
+		detachMS += msSince(start);
+		if(manager.size() != 0) {
+			std::cerr << "round " << r << ": " << manager.size()
+			          << " devices open after detaching" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	std::cout << "  attach & open: " << attachMS / (rounds * batch) << " ms/device" << std::endl;
+	if(rounds > 1) {
+		std::cout << "  detach & close: " << detachMS / ((rounds - 1) * batch)
+		          << " ms/device" << std::endl;
+	}
+
+	// dispatch to the last device by instance id
+	const int iterations = 1000000;
+	SDL_Event event;
+	SDL_zero(event);
+	event.type = SDL_CONTROLLERAXISMOTION;
+	event.caxis.which = manager.get(batch - 1)->getInstanceID();
+	event.caxis.axis = SDL_CONTROLLER_AXIS_LEFTX;
+	Clock::time_point start = Clock::now();
+	for(int i = 0; i < iterations; ++i) {
+		event.caxis.value = (i & 1 ? 20000 : -20000); // never a repeat
+		manager.handleEvent(&event);
+	}
+	std::cout << "  dispatch with " << batch << " devices: "
+	          << msSince(start) * 1000000.0 / iterations << " ns/event" << std::endl;
+
+	manager.closeAll();
+	detachAll();
+	Device::sender = nullptr;
+	sender.stop();
+	SDL_Quit();
+	return EXIT_SUCCESS;
+#else
+	std::cout << "bench_hotplug: skipped, virtual joysticks require SDL 2.0.14" << std::endl;
+	return EXIT_SUCCESS;
+#endif
+}
@@ -0,0 +1,163 @@
+/*==============================================================================
+
+	bench_latency.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include "../config.h" // automake config defines
+
+#include <cstdlib>
+#include <iostream>
+
+#ifdef HAVE_SENDMMSG
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "DatagramSocket.h"
+#include "OscMessage.h"
+
+// sends a typical game controller axis message with DatagramSocket, as joyosc
+// does, to a receiver bound on a loopback UDP port, then to a receiver bound
+// on a unix domain datagram socket path, & times each message from add()
+// until recv() returns it
+
+typedef std::chrono::steady_clock Clock;
+
+// open receiver socket bound to a loopback UDP port, sets the port
+static int openPort(unsigned int &port) {
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if(fd < 0) {return -1;}
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0; // any free port
+	if(bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+	   getsockname(fd, (struct sockaddr *)&address, &length) < 0) {
+		close(fd);
+		return -1;
+	}
+	port = ntohs(address.sin_port);
+	return fd;
+}
+
+// open receiver socket bound to a unix domain socket path
+static int openSocket(const std::string &path) {
+	int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if(fd < 0) {return -1;}
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	unlink(path.c_str());
+	if(bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// send & receive messages one at a time, prints latency stats,
+// returns false on error
+static bool measure(const char *name, DatagramSocket &sender, int receiver,
+                    const char *data, size_t size, int iterations) {
+	std::vector<double> times(iterations);
+	char buffer[4096];
+	for(int i = 0; i < iterations; ++i) {
+		Clock::time_point start = Clock::now();
+		sender.add(data, size);
+		sender.flush();
+		if(recv(receiver, buffer, sizeof(buffer), 0) != (ssize_t)size) {
+			std::cerr << name << ": receive failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+		std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+		times[i] = elapsed.count();
+	}
+	std::sort(times.begin(), times.end());
+	double sum = 0;
+	for(double time : times) {sum += time;}
+	std::cout << "  " << name << ": mean " << sum / iterations << " us"
+	          << ", median " << times[iterations / 2] << " us"
+	          << ", p99 " << times[iterations * 99 / 100] << " us" << std::endl;
+	return true;
+}
+
+int main(int argc, char **argv) {
+	int iterations = (argc > 1 ? atoi(argv[1]) : 100000);
+	if(iterations <= 0) {
+		std::cerr << "usage: bench_latency [iterations]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	char data[256];
+	OscMessage message("/joyosc/devices/gc0/axis");
+	message.addString("leftx");
+	message.addFloat(0.5f);
+	size_t size = message.write(data, sizeof(data));
+
+	std::cout << "bench_latency: " << message.getPath() << " "
+	          << message.getTypes() + 1 << ", " << iterations
+	          << " iterations" << std::endl;
+
+	unsigned int port = 0;
+	int udp = openPort(port);
+	DatagramSocket udpSender;
+	if(udp < 0 || !udpSender.open("127.0.0.1", port)) {
+		std::cerr << "could not open udp sockets: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool ok = measure("udp ", udpSender, udp, data, size, iterations);
+	udpSender.close();
+	close(udp);
+	if(!ok) {return EXIT_FAILURE;}
+
+	std::string path = "/tmp/bench_latency." + std::to_string(getpid());
+	int unixSocket = openSocket(path);
+	DatagramSocket unixSender;
+	if(unixSocket < 0 || !unixSender.openUnix(path)) {
+		std::cerr << "could not open unix sockets: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+	ok = measure("unix", unixSender, unixSocket, data, size, iterations);
+	unixSender.close();
+	close(unixSocket);
+	unlink(path.c_str());
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+int main(int argc, char **argv) {
+	std::cout << "bench_latency: skipped, requires sendmmsg" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*==============================================================================
+
+	test_coalescer.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Coalescer.h"
+
+// pushes controller axis events through the Coalescer & checks which are
+// kept, trigger presses & releases within one drain must never be merged
+
+static int s_failures = 0;
+
+// print failure message if the condition is false
+static void check(bool condition, const std::string &message) {
+	if(!condition) {
+		std::cerr << "FAIL: " << message << std::endl;
+		s_failures++;
+	}
+}
+
+// push a controller axis motion event
+static void pushAxis(SDL_JoystickID which, Uint8 axis, Sint16 value) {
+	SDL_Event event;
+	SDL_zero(event);
+	event.type = SDL_CONTROLLERAXISMOTION;
+	event.caxis.which = which;
+	event.caxis.axis = axis;
+	event.caxis.value = value;
+	SDL_PushEvent(&event);
+}
+
+// drain & return the kept axis values in order
+static std::vector<Sint16> keptValues(Coalescer &coalescer) {
+	std::vector<Sint16> values;
+	size_t count = coalescer.drain();
+	for(size_t i = 0; i < count; ++i) {
+		if(coalescer.isKept(i) && coalescer.event(i).type == SDL_CONTROLLERAXISMOTION) {
+			values.push_back(coalescer.event(i).caxis.value);
+		}
+	}
+	return values;
+}
+
+int main(int argc, char **argv) {
+	if(SDL_Init(SDL_INIT_EVENTS) < 0) {
+		std::cerr << "could not initialize SDL: " << SDL_GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+	Coalescer coalescer;
+	std::vector<Sint16> values;
+
+	// motion on one side of zero is merged into the latest value
+	pushAxis(0, SDL_CONTROLLER_AXIS_LEFTX, 1000);
+	pushAxis(0, SDL_CONTROLLER_AXIS_LEFTX, 2000);
+	pushAxis(0, SDL_CONTROLLER_AXIS_LEFTX, 3000);
+	values = keptValues(coalescer);
+	check(values == std::vector<Sint16>({3000}), "axis motion not merged");
+
+	// trigger press & release in one drain: both edges are kept
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 16384);
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 32767);
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 0);
+	values = keptValues(coalescer);
+	check(values == std::vector<Sint16>({32767, 0}),
+	      "trigger press & release merged");
+
+	// release & press again: each edge is kept, motion between is merged
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 32767);
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 0);
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 100);
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 200);
+	values = keptValues(coalescer);
+	check(values == std::vector<Sint16>({32767, 0, 200}),
+	      "trigger release & press again merged");
+
+	// other devices & axes are coalesced separately
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERRIGHT, 32767);
+	pushAxis(1, SDL_CONTROLLER_AXIS_TRIGGERRIGHT, 32767);
+	pushAxis(0, SDL_CONTROLLER_AXIS_TRIGGERRIGHT, 0);
+	values = keptValues(coalescer);
+	check(values == std::vector<Sint16>({32767, 32767, 0}),
+	      "trigger edges merged across devices");
+
+	SDL_Quit();
+
+	if(s_failures > 0) {
+		std::cerr << s_failures << " check(s) failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,199 @@
+/*==============================================================================
+
+	test_inputs.cpp
+
+	joyosc: a device event to osc bridge
+
+	Copyright (C) 2026 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "GameController.h"
+#include "GameControllerIgnore.h"
+#include "GameControllerRemapping.h"
+
+// opens a virtual game controller with button ignores & remappings, moves
+// its inputs, & checks what is sent to a receiver on a loopback UDP port,
+// exits with 77 to skip if SDL has no virtual joysticks
+
+// automake test skip exit code
+#define EXIT_SKIP 77
+
+// triggers on the positive half axis so they start released
+static const char *mapping = ",joyosc virtual controller,"
+	"a:b0,b:b1,x:b2,y:b3,back:b4,guide:b5,start:b6,leftstick:b7,rightstick:b8,"
+	"leftshoulder:b9,rightshoulder:b10,dpup:b11,dpdown:b12,dpleft:b13,dpright:b14,"
+	"leftx:a0,lefty:a1,rightx:a2,righty:a3,lefttrigger:+a4,righttrigger:+a5,";
+
+static int s_failures = 0;
+
+// print failure message if the condition is false
+static void check(bool condition, const std::string &message) {
+	if(!condition) {
+		std::cerr << "FAIL: " << message << std::endl;
+		s_failures++;
+	}
+}
+
+// open receiver socket bound to a loopback UDP port, sets the port
+static int openPort(unsigned int &port) {
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if(fd < 0) {return -1;}
+	struct sockaddr_in address;
+	socklen_t length = sizeof(address);
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0; // any free port
+	if(bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+	   getsockname(fd, (struct sockaddr *)&address, &length) < 0) {
+		close(fd);
+		return -1;
+	}
+	port = ntohs(address.sin_port);
+	return fd;
+}
+
+// receive the next datagram as a string, waits up to 100 ms,
+// returns "" if nothing arrived
+static std::string receive(int fd) {
+	struct pollfd pfd = {fd, POLLIN, 0};
+	if(poll(&pfd, 1, 100) <= 0) {return "";}
+	char buffer[4096];
+	ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+	return (size > 0 ? std::string(buffer, size) : "");
+}
+
+// returns true if the OSC datagram contains the path & string argument
+static bool contains(const std::string &datagram, const std::string &path,
+                     const std::string &name) {
+	return datagram.find(path + '\0') != std::string::npos &&
+	       datagram.find(name + '\0') != std::string::npos;
+}
+
+// pass pending controller events to the controller & send
+static void update(GameController &controller, Sender &sender) {
+	SDL_Event event;
+	SDL_JoystickUpdate();
+	while(SDL_PollEvent(&event)) {
+		controller.handleEvent(&event);
+	}
+	sender.flush();
+}
+
+int main(int argc, char **argv) {
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+	if(SDL_Init(SDL_INIT_GAMECONTROLLER) < 0) {
+		std::cerr << "skipped, could not initialize SDL: " << SDL_GetError() << std::endl;
+		return EXIT_SKIP;
+	}
+	int sdlIndex = SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER,
+		SDL_CONTROLLER_AXIS_MAX, 15, 0);
+	if(sdlIndex < 0) {
+		std::cerr << "skipped, no virtual joysticks: " << SDL_GetError() << std::endl;
+		SDL_Quit();
+		return EXIT_SKIP;
+	}
+	char guid[33];
+	SDL_JoystickGetGUIDString(SDL_JoystickGetDeviceGUID(sdlIndex), guid, sizeof(guid));
+	GameController::addMappingString(guid + std::string(mapping));
+
+	unsigned int port = 0;
+	int receiver = openPort(port);
+	if(receiver < 0) {
+		std::cerr << "could not open receiver: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+	Sender sender;
+	DestinationSettings destination;
+	destination.port = port;
+	sender.addDestination(destination);
+	sender.start();
+	Device::sender = &sender;
+
+	// triggers are sent as buttons by default
+	GameControllerIgnore ignore;
+	ignore.buttons.insert("lefttrigger");
+	GameControllerRemapping remapping;
+	remapping.set(BUTTON, "righttrigger", "r2");
+	GameControllerSettings gcs;
+	DeviceSettings settings;
+	settings.type = GAMECONTROLLER;
+	settings.address = "/gc";
+	settings.remap = &remapping;
+	settings.ignore = &ignore;
+	settings.data = &gcs;
+
+	GameController controller;
+	DeviceIndex index;
+	index.index = 0;
+	index.sdlIndex = sdlIndex;
+	if(!controller.open(index, &settings)) {
+		std::cerr << "could not open virtual controller" << std::endl;
+		return EXIT_FAILURE;
+	}
+	SDL_Joystick *joystick = controller.getJoystick();
+	std::string buttonPath = controller.getSendPath(BUTTON);
+	std::string axisPath = controller.getSendPath(AXIS);
+	update(controller, sender);
+	while(receive(receiver) != "") {}
+
+	// ignored trigger button: nothing is sent
+	uint64_t sent = sender.messagesSent();
+	SDL_JoystickSetVirtualAxis(joystick, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 32767);
+	update(controller, sender);
+	check(sender.messagesSent() == sent, "ignored lefttrigger button was sent");
+	check(receive(receiver) == "", "ignored lefttrigger button was received");
+
+	// remapped trigger button: sent with the remapped button name
+	SDL_JoystickSetVirtualAxis(joystick, SDL_CONTROLLER_AXIS_TRIGGERRIGHT, 32767);
+	update(controller, sender);
+	check(contains(receive(receiver), buttonPath, "r2"),
+	      "righttrigger button not sent as remapped r2");
+
+	// button ignores do not apply to triggers sent as axes
+	controller.setTriggersAsAxes(true);
+	SDL_JoystickSetVirtualAxis(joystick, SDL_CONTROLLER_AXIS_TRIGGERLEFT, 16384);
+	update(controller, sender);
+	check(contains(receive(receiver), axisPath, "lefttrigger"),
+	      "lefttrigger axis not sent with triggers as axes");
+
+	controller.close();
+	Device::sender = nullptr;
+	sender.stop();
+	close(receiver);
+	SDL_JoystickDetachVirtual(sdlIndex);
+	SDL_Quit();
+
+	if(s_failures > 0) {
+		std::cerr << s_failures << " check(s) failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+#else
+	std::cerr << "skipped, virtual joysticks require SDL 2.0.14" << std::endl;
+	return EXIT_SKIP;
+#endif
+}